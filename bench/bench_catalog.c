@@ -0,0 +1,142 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "utils.h"
+#include "catalog.h"
+#include "live.h"
+
+
+#define SKUS     1000000
+#define LOOKUPS  (1 << 22)
+#define ROUNDS   3
+
+
+static char image[] = "build/bench_catalog.img";
+static atomic_bool stopping = false;
+static atomic_ulong reloads = 0;
+
+static double s_elapsed(const struct timespec *start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Map the compiled catalog again and again, publishing each mapping, until stopped
+static void *s_reload(void *arg) {
+	while (!atomic_load(&stopping)) {
+		if (!live_reload(arg, image)) {
+			ERROR("Unable to reload catalog");
+		}
+		atomic_fetch_add(&reloads, 1);
+	}
+	return NULL;
+}
+
+// Write the i-th SKU, as a 12-digit code like a UPC
+static int s_sku(char *out, unsigned long i) {
+	return sprintf(out, "%012lu", (i * 2654435761UL) % 1000000000000UL);
+}
+
+
+int main(void) {
+	char path[] = "build/bench_catalog.XXXXXX", sku[CATALOG_SKU_MAX + 1];
+	int fd = mkstemp(path);
+	if (fd < 0) {
+		ERROR("Unable to create catalog");
+	}
+	FILE *file = fdopen(fd, "w");
+	for (unsigned long i = 0; i < SKUS; i++) {
+		s_sku(sku, i);
+		fprintf(file, "%s %lu.%02lu Product %lu\n", sku, i % 5000, i % 100, i);
+	}
+	fclose(file);
+
+	Catalog catalog;
+	double best = 0;
+	for (int r = 0; r < ROUNDS; r++) {
+		struct timespec start;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		if (!catalog_load(&catalog, path)) {
+			ERROR("Unable to load catalog");
+		}
+		double secs = s_elapsed(&start);
+		if (r == 0 || secs < best)
+			best = secs;
+		if (r + 1 < ROUNDS)
+			catalog_free(&catalog);
+	}
+	unlink(path);
+	printf("%d SKUs loaded in %.1f ms\n", SKUS, best * 1e3);
+	if (!catalog_save(&catalog, image)) {
+		ERROR("Unable to compile catalog");
+	}
+	catalog_free(&catalog);
+	for (int r = 0; r < ROUNDS; r++) {
+		struct timespec start;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		if (!catalog_map(&catalog, image)) {
+			ERROR("Unable to map catalog");
+		}
+		double secs = s_elapsed(&start);
+		if (r == 0 || secs < best)
+			best = secs;
+		if (r + 1 < ROUNDS)
+			catalog_free(&catalog);
+	}
+	printf("%d SKUs mapped in %.3f ms\n", SKUS, best * 1e3);
+
+	// Look up SKUs in an order unrelated to their entries, so most lookups miss the caches
+	char (*skus)[16] = malloc(LOOKUPS * sizeof(*skus));
+	uint8 *lens = malloc(LOOKUPS);
+	for (unsigned long i = 0; i < LOOKUPS; i++)
+		lens[i] = s_sku(skus[i], (i * 40503) % SKUS);
+	struct timespec start;
+	Currency total = 0;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (unsigned long i = 0; i < LOOKUPS; i++) {
+		const CatalogEntry *e = catalog_find(&catalog, skus[i], lens[i]);
+		total += e != NULL ? e->price : 0;
+	}
+	double secs = s_elapsed(&start);
+	if (total == 0)
+		fprintf(stderr, "%s: no SKUs found\n", PROGRAM_TITLE);
+	printf("lookup %.1f ns per SKU, mapped\n", secs * 1e9 / LOOKUPS);
+	catalog_free(&catalog);
+
+	// The same lookups through a live catalog, alone and then while it is reloaded
+	LiveCatalog live;
+	if (!live_init(&live, image)) {
+		ERROR("Unable to map catalog");
+	}
+	LiveReader *reader = live_register(&live);
+	for (int pass = 0; pass < 2; pass++) {
+		pthread_t reloader;
+		if (pass == 1 && pthread_create(&reloader, NULL, s_reload, &live) != 0) {
+			ERROR("Unable to start reloader");
+		}
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (unsigned long i = 0; i < LOOKUPS; i++) {
+			const CatalogEntry *e = catalog_find(live_enter(&live, reader), skus[i], lens[i]);
+			total += e != NULL ? e->price : 0;
+			live_exit(reader);
+		}
+		secs = s_elapsed(&start);
+		if (pass == 1) {
+			atomic_store(&stopping, true);
+			pthread_join(reloader, NULL);
+			printf("lookup %.1f ns per SKU, live, across %lu reloads\n", secs * 1e9 / LOOKUPS, atomic_load(&reloads));
+		}
+		else
+			printf("lookup %.1f ns per SKU, live\n", secs * 1e9 / LOOKUPS);
+	}
+	live_free(&live);
+	unlink(image);
+	free(skus);
+	free(lens);
+	return 0;
+}
@@ -0,0 +1,68 @@
+#include <clocale>
+#include <cstdio>
+#include <ctime>
+
+#include "currency.hpp"
+
+#if __has_include(<fmt/format.h>)
+#define BENCH_FMT
+#endif
+
+
+#define REPORT_LINES 5000000
+
+
+using cashregister::Usd;
+
+
+// Nanoseconds elapsed since start
+static double s_elapsed_ns(const timespec &start) {
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start.tv_sec) * 1e9 + (now.tv_nsec - start.tv_nsec);
+}
+
+// Amounts vary in width, as they would in a report of real transactions
+static Currency s_amount(unsigned long i) {
+	return (i * 2654435761UL) % 100000000UL;
+}
+
+
+int main(void) {
+	// Match the locale used by the tests, so sprint_currency groups its digits too
+	setlocale(LC_NUMERIC, "");
+	char buffer[MAX_BUFFER_SIZE];
+	unsigned long checksum = 0;
+	timespec start;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (unsigned long i = 0; i < REPORT_LINES; i++) {
+		sprint_currency(buffer, MAX_BUFFER_SIZE, (char*) "%s", s_amount(i));
+		checksum += buffer[1];
+	}
+	double c_ns = s_elapsed_ns(start) / REPORT_LINES;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (unsigned long i = 0; i < REPORT_LINES; i++) {
+		*Usd::from_minor(s_amount(i)).format_to(buffer) = '\0';
+		checksum += buffer[1];
+	}
+	double cpp_ns = s_elapsed_ns(start) / REPORT_LINES;
+
+#ifdef BENCH_FMT
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (unsigned long i = 0; i < REPORT_LINES; i++) {
+		*fmt::format_to(buffer, "{}", Usd::from_minor(s_amount(i))) = '\0';
+		checksum += buffer[1];
+	}
+	double fmt_ns = s_elapsed_ns(start) / REPORT_LINES;
+#endif
+
+	printf("%d report lines (checksum %lu)\n", REPORT_LINES, checksum);
+	printf("sprint_currency:  %6.1f ns/line\n", c_ns);
+	printf("Usd::format_to:   %6.1f ns/line (%.1fx)\n", cpp_ns, c_ns / cpp_ns);
+#ifdef BENCH_FMT
+	printf("fmt::format_to:   %6.1f ns/line (%.1fx)\n", fmt_ns, c_ns / fmt_ns);
+#endif
+	return 0;
+}
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "utils.h"
+#include "histogram.h"
+#include "journal.h"
+
+
+#define LINES   (1 << 22)
+#define BATCH   4096
+#define ROUNDS  5
+
+
+static Histogram hist;
+
+
+static double s_elapsed(const struct timespec *start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Best time to scan the journal, counting each batch of amounts in the histogram if asked
+static double s_scan(const char *data, size_t len, bool count) {
+	static Currency amounts[BATCH];
+	double best = 0;
+	for (int r = 0; r < ROUNDS; r++) {
+		struct timespec start;
+		size_t offset = 0, consumed, n;
+		Currency total = 0;
+		histogram_init(&hist);
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		while (offset < len) {
+			n = journal_parse(data + offset, len - offset, true, amounts, BATCH, &consumed);
+			for (size_t i = 0; i < n; i++)
+				total += amounts[i];
+			if (count)
+				histogram_add_batch(&hist, amounts, n);
+			offset += consumed;
+		}
+		double secs = s_elapsed(&start);
+		if (total == 0)
+			fprintf(stderr, "%s: empty journal\n", PROGRAM_TITLE);
+		if (r == 0 || secs < best)
+			best = secs;
+	}
+	return best;
+}
+
+
+int main(void) {
+	size_t cap = LINES * 16, len = 0;
+	char *data = malloc(cap);
+	if (data == NULL) {
+		ERROR("Out of memory");
+	}
+	for (unsigned long i = 0; i < LINES; i++)
+		len += snprintf(data + len, cap - len, "%lu.%02lu\n", (i * 7919) % 100000, i % 100);
+
+	double plain = s_scan(data, len, false), counted = s_scan(data, len, true);
+	// The histogram on its own, over amounts already scanned
+	Currency *amounts = malloc(LINES * sizeof(Currency));
+	size_t consumed;
+	struct timespec start;
+	journal_parse(data, len, true, amounts, LINES, &consumed);
+	double alone = 0;
+	for (int r = 0; r < ROUNDS; r++) {
+		histogram_init(&hist);
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		histogram_add_batch(&hist, amounts, LINES);
+		double secs = s_elapsed(&start);
+		if (r == 0 || secs < alone)
+			alone = secs;
+	}
+	printf("%d lines\n", LINES);
+	printf("scan             %6.1f ns per line\n", plain * 1e9 / LINES);
+	printf("scan + histogram %6.1f ns per line, %.2f%% overhead\n", counted * 1e9 / LINES,
+			100 * (counted - plain) / plain);
+	printf("histogram alone  %6.2f ns per amount\n", alone * 1e9 / LINES);
+	free(amounts);
+	free(data);
+	return 0;
+}
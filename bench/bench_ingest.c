@@ -0,0 +1,67 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "utils.h"
+#include "pipeline.h"
+
+
+#define LINES       (1 << 22)
+#define ROUNDS            3
+
+
+static double s_elapsed(const struct timespec *start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Evict the journal from the page cache, so each run reads from the device
+static void s_drop_cache(int fd) {
+	fdatasync(fd);
+	posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+}
+
+// Best time to total the journal, from a cold or warm cache
+static double s_run(int fd, IngestMode mode, bool cold, size_t size) {
+	double best = 0;
+	for (int r = 0; r < ROUNDS; r++) {
+		JournalTotal result;
+		struct timespec start;
+		if (cold)
+			s_drop_cache(fd);
+		lseek(fd, 0, SEEK_SET);
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		if (!pipeline_total(fd, mode, &result, NULL) || result.lines != LINES)
+			fprintf(stderr, "%s: totalled %lu of %d lines\n", PROGRAM_TITLE, result.lines, LINES);
+		double secs = s_elapsed(&start);
+		if (r == 0 || secs < best)
+			best = secs;
+	}
+	return size / best / (1 << 20);
+}
+
+
+int main(void) {
+	// Written beside the build rather than in /tmp, which may be memory backed
+	char path[] = "build/bench_ingest.XXXXXX";
+	int fd = mkstemp(path);
+	if (fd < 0) {
+		ERROR("Unable to create journal");
+	}
+	unlink(path);
+	FILE *journal = fdopen(dup(fd), "w");
+	for (unsigned long i = 0; i < LINES; i++)
+		fprintf(journal, "$%lu.%02lux%lu\n", (i * 7919) % 100000, i % 100, i % 3 + 1);
+	fclose(journal);
+	size_t size = lseek(fd, 0, SEEK_END);
+
+	printf("%d lines, %.0f MiB\n", LINES, size / (double) (1 << 20));
+	printf("reader       cold MiB/s   warm MiB/s\n");
+	printf("pread      %12.0f %12.0f\n", s_run(fd, INGEST_PREAD, true, size), s_run(fd, INGEST_PREAD, false, size));
+	printf("io_uring   %12.0f %12.0f\n", s_run(fd, INGEST_AUTO, true, size), s_run(fd, INGEST_AUTO, false, size));
+	close(fd);
+	return 0;
+}
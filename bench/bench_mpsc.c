@@ -0,0 +1,57 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "utils.h"
+#include "mpsc.h"
+
+
+#define CAPACITY      65536
+#define ENTRIES   (1 << 22)
+#define MAX_PRODUCERS    64
+
+
+static MpscRing ring;
+static long per_producer;
+
+
+static double s_elapsed(const struct timespec *start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void *s_produce(void *arg) {
+	for (long i = 0; i < per_producer; i++) {
+		while (!mpsc_push(&ring, 1))
+			sched_yield();
+	}
+	return NULL;
+}
+
+
+int main(void) {
+	pthread_t producers[MAX_PRODUCERS];
+	printf("%d entries through a ring of %d\n", ENTRIES, CAPACITY);
+	printf("producers   entries/s     full pushes\n");
+	for (int n = 1; n <= MAX_PRODUCERS; n *= 2) {
+		MpscAggregator agg;
+		struct timespec start;
+		mpsc_init(&ring, CAPACITY);
+		per_producer = ENTRIES / n;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		mpsc_aggregator_start(&agg, &ring);
+		for (int i = 0; i < n; i++)
+			pthread_create(&producers[i], NULL, s_produce, NULL);
+		for (int i = 0; i < n; i++)
+			pthread_join(producers[i], NULL);
+		Currency total = mpsc_aggregator_stop(&agg);
+		double secs = s_elapsed(&start);
+		if (total != (Currency) per_producer * n)
+			fprintf(stderr, "%s: expected %ld entries, totalled %lu\n", PROGRAM_TITLE, per_producer * n, total);
+		printf("%9d %11.0f %15lu\n", n, total / secs, atomic_load(&ring.rejected));
+		mpsc_free(&ring);
+	}
+	return 0;
+}
@@ -0,0 +1,66 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "utils.h"
+#include "shard.h"
+
+
+#define ADDS        (1 << 24)
+#define MAX_THREADS 64
+
+
+static ShardedTotal sharded;
+static atomic_ulong shared_total;
+static long per_thread;
+
+
+static double s_elapsed(const struct timespec *start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void *s_add_sharded(void *arg) {
+	size_t shard = shard_claim(&sharded);
+	for (long i = 0; i < per_thread; i++)
+		shard_add(&sharded, shard, 1);
+	return NULL;
+}
+
+static void *s_add_shared(void *arg) {
+	for (long i = 0; i < per_thread; i++)
+		atomic_fetch_add_explicit(&shared_total, 1, memory_order_relaxed);
+	return NULL;
+}
+
+// Run n threads through the given adder, returning adds per second
+static double s_run(int n, void *(*adder)(void*)) {
+	pthread_t threads[MAX_THREADS];
+	struct timespec start;
+	per_thread = ADDS / n;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (int i = 0; i < n; i++)
+		pthread_create(&threads[i], NULL, adder, NULL);
+	for (int i = 0; i < n; i++)
+		pthread_join(threads[i], NULL);
+	return per_thread * n / s_elapsed(&start);
+}
+
+
+int main(void) {
+	printf("%d adds\n", ADDS);
+	printf("threads   sharded adds/s   fetch_add adds/s\n");
+	for (int n = 1; n <= MAX_THREADS; n *= 2) {
+		shard_init(&sharded, n);
+		atomic_store(&shared_total, 0);
+		double sharded_rate = s_run(n, s_add_sharded);
+		double shared_rate = s_run(n, s_add_shared);
+		if (shard_snapshot(&sharded, NULL) != atomic_load(&shared_total))
+			fprintf(stderr, "%s: sharded and shared totals differ\n", PROGRAM_TITLE);
+		printf("%7d %16.0f %18.0f\n", n, sharded_rate, shared_rate);
+		shard_free(&sharded);
+	}
+	return 0;
+}
@@ -0,0 +1,37 @@
+#include <stdio.h>
+#include <time.h>
+
+#include "utils.h"
+#include "sketch.h"
+
+
+#define AMOUNTS (1 << 24)
+
+
+static Sketch sketch;
+
+
+static double s_elapsed(const struct timespec *start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+int main(void) {
+	struct timespec start;
+	double quantiles[] = {0.5, 0.95, 0.99};
+	sketch_init(&sketch);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	// A permutation of 0 .. AMOUNTS-1, so the true rank of every amount is the amount itself
+	for (unsigned long i = 0; i < AMOUNTS; i++)
+		sketch_add(&sketch, (i * 2654435761UL) % AMOUNTS);
+	double secs = s_elapsed(&start);
+	printf("%d amounts in %lu bytes, %.1f ns per amount\n", AMOUNTS, sizeof(Sketch), secs * 1e9 / AMOUNTS);
+	printf("quantile   rank error\n");
+	for (int i = 0; i < 3; i++) {
+		double rank = sketch_quantile(&sketch, quantiles[i]) / (double) AMOUNTS;
+		printf("%8.2f %11.4f%%\n", quantiles[i], 100 * (rank - quantiles[i]));
+	}
+	return 0;
+}
@@ -0,0 +1,63 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "utils.h"
+#include "sum.h"
+
+
+#define LARGE   (1 << 23)       // 64 MiB, well beyond the caches
+#define SMALL   (1 << 12)       // 32 KiB, within L1 or L2
+#define ROUNDS  5
+
+
+static const SumKernel kernels[] = {SUM_SCALAR, SUM_SSE, SUM_AVX2, SUM_AVX512};
+static const char *names[] = {"scalar", "sse", "avx2", "avx512"};
+
+
+static double s_elapsed(const struct timespec *start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Best time, in ns per amount, to sum n amounts repeats times with a kernel
+static double s_time(const Currency *amounts, size_t n, size_t repeats, SumKernel kernel) {
+	double best = 0;
+	for (int r = 0; r < ROUNDS; r++) {
+		struct timespec start;
+		Sum sum;
+		sum_init(&sum);
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (size_t i = 0; i < repeats; i++)
+			sum_amounts(&sum, amounts, n, kernel);
+		double secs = s_elapsed(&start);
+		if (sum.low == 0)
+			fprintf(stderr, "%s: empty sum\n", PROGRAM_TITLE);
+		if (r == 0 || secs < best)
+			best = secs;
+	}
+	return best * 1e9 / (n * repeats);
+}
+
+
+int main(void) {
+	Currency *amounts = malloc(LARGE * sizeof(Currency));
+	if (amounts == NULL) {
+		ERROR("Out of memory");
+	}
+	for (size_t i = 0; i < LARGE; i++)
+		amounts[i] = (i * 7919) % 100000;
+	printf("%-8s %14s %14s\n", "kernel", "in cache", "in memory");
+	for (size_t k = 0; k < sizeof(kernels) / sizeof(*kernels); k++) {
+		if (!sum_supported(kernels[k])) {
+			printf("%-8s %14s\n", names[k], "unsupported");
+			continue;
+		}
+		double small = s_time(amounts, SMALL, LARGE / SMALL, kernels[k]);
+		double large = s_time(amounts, LARGE, 1, kernels[k]);
+		printf("%-8s %8.3f ns/op %8.3f ns/op\n", names[k], small, large);
+	}
+	free(amounts);
+	return 0;
+}
@@ -0,0 +1,85 @@
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "utils.h"
+#include "daemon.h"
+#include "wire.h"
+
+
+#define SOCKET_PATH "/tmp/cashregister_bench.sock"
+#define ENTRIES 2000000
+#define BATCH   WIRE_MAX_ENTRIES
+
+#define ENTRY      "$1.01\n"
+#define ENTRY_LEN  (sizeof(ENTRY) - 1)
+
+
+static double s_elapsed(const struct timespec *start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Send entries as text lines, a batch at a time, reading a reply line per entry
+static void s_bench_text(void) {
+	static char batch[BATCH * ENTRY_LEN], reply[DAEMON_OUT_SIZE];
+	int fd = wire_connect(SOCKET_PATH);
+	for (int i = 0; i < BATCH; i++)
+		memcpy(batch + i * ENTRY_LEN, ENTRY, ENTRY_LEN);
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (long sent = 0; sent < ENTRIES; sent += BATCH) {
+		if (write(fd, batch, sizeof(batch)) != sizeof(batch))
+			return;
+		for (int lines = 0; lines < BATCH; ) {
+			ssize_t len = read(fd, reply, sizeof(reply));
+			if (len <= 0)
+				return;
+			for (ssize_t j = 0; j < len; j++)
+				lines += reply[j] == '\n';
+		}
+	}
+	printf("text:   %10.0f entries/s\n", ENTRIES / s_elapsed(&start));
+	close(fd);
+}
+
+// Send entries as binary frames, a batch per frame
+static void s_bench_binary(void) {
+	static WireFrame frame;
+	Currency total = 0;
+	int fd = wire_connect(SOCKET_PATH);
+	wire_frame_init(&frame, 1);
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (long sent = 0; sent < ENTRIES; sent += BATCH) {
+		for (int i = 0; i < BATCH; i++)
+			wire_add_currency(&frame, 101, 1);
+		if (!wire_submit(fd, &frame, &total))
+			return;
+	}
+	printf("binary: %10.0f entries/s (total %lu cents)\n", ENTRIES / s_elapsed(&start), total);
+	close(fd);
+}
+
+
+int main(void) {
+	pid_t daemon = fork();
+	if (daemon == 0)
+		exit(daemon_run(SOCKET_PATH));
+	// Wait for the daemon to start listening
+	int fd;
+	while ((fd = wire_connect(SOCKET_PATH)) < 0)
+		usleep(1000);
+	close(fd);
+
+	printf("%d entries, %d per batch\n", ENTRIES, BATCH);
+	s_bench_text();
+	s_bench_binary();
+	kill(daemon, SIGTERM);
+	waitpid(daemon, NULL, 0);
+	return 0;
+}
@@ -0,0 +1,34 @@
+#include <stddef.h>
+
+#include "utils.h"
+
+
+#ifndef ARENA_H
+#define ARENA_H
+
+// *** Constants
+#define ARENA_CHUNK_SIZE 4096
+#define ARENA_ALIGN        16
+
+// *** Type Definitions
+typedef struct ArenaChunk {
+	struct ArenaChunk *next;
+	size_t size;
+	size_t used;
+	_Alignas(ARENA_ALIGN) unsigned char data[];
+} ArenaChunk;
+
+typedef struct {
+	ArenaChunk *head;
+	ArenaChunk *current;
+	size_t chunk_size;
+} Arena;
+
+// *** Public Interface
+void arena_init(Arena*, size_t);
+void *arena_alloc(Arena*, size_t);
+char *arena_strdup(Arena*, const char*);
+void arena_reset(Arena*);
+void arena_free(Arena*);
+
+#endif
@@ -0,0 +1,61 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils.h"
+
+
+#ifndef CATALOG_H
+#define CATALOG_H
+
+// *** Constants
+#define CATALOG_SKU_MAX     19      // Longest SKU, so that an entry fills half a cache line
+#define CATALOG_SKU_PREFIX  '#'     // Marks an input as a SKU rather than an amount
+#define CATALOG_LAMBDA      2       // Average number of SKUs per bucket of the hash
+#define CATALOG_SLACK       100     // One spare slot per this many SKUs, so the last buckets place quickly
+#define CATALOG_MAX_PILOT   (1u << 16)
+#define CATALOG_MAX_SEEDS   16
+#define CATALOG_MAGIC       0x54435243    // "CRCT", little-endian
+#define CATALOG_VERSION     1
+#define CATALOG_ALIGN       64            // Of each section of a compiled catalog
+#define CATALOG_SUFFIX      ".img"        // Appended to a catalog's path to name it compiled, by default
+
+// *** Type Definitions
+// A product; its name is held in the catalog's names, and is empty if none was given
+typedef struct {
+	_Alignas(32) Currency price;
+	uint32 name;            // Offset of the NUL-terminated name within names
+	uint8 len;
+	char sku[CATALOG_SKU_MAX];
+} CatalogEntry;
+
+// Products indexed by a minimal perfect hash, built by hash and displace: each SKU hashes
+// 	to a bucket, and each bucket holds the pilot that places all of its SKUs, mixed with
+// 	their second hash, into distinct slots. Slots are entries, save the 1% past the last
+// 	entry, which are remapped onto entries left unused. A lookup reads one pilot and one
+// 	entry, and rarely a remapped slot. A compiled catalog is mapped rather than built, and
+// 	its arrays point into the mapping, which is read-only
+typedef struct {
+	uint64 seed;
+	size_t count;           // Entries, one per distinct SKU
+	size_t slots;
+	size_t buckets;
+	uint16 *pilots;          // One per bucket; few buckets need more than a few hundred tries
+	uint32 *remap;          // Entry of each slot past the last entry
+	CatalogEntry *entries;
+	char *names;
+	size_t names_len;
+	void *image;            // The mapping of a compiled catalog, or NULL if it was built
+	size_t image_len;
+} Catalog;
+
+// *** Public Interface
+bool catalog_build(Catalog*, const char*, size_t);
+bool catalog_load(Catalog*, const char*);
+bool catalog_save(const Catalog*, const char*);
+bool catalog_map(Catalog*, const char*);
+const CatalogEntry *catalog_find(const Catalog*, const char*, size_t);
+Currency catalog_scan(const Catalog*, const char*, size_t, unsigned*, const CatalogEntry**);
+const char *catalog_name(const Catalog*, const CatalogEntry*);
+void catalog_free(Catalog*);
+
+#endif
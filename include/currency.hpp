@@ -0,0 +1,302 @@
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "utils.h"
+#include "io.h"
+
+
+#ifndef CURRENCY_HPP
+#define CURRENCY_HPP
+
+// *** Macros
+// Literals are checked at compile time whenever the compiler allows it
+#if defined(__cpp_consteval)
+#define CR_CONSTEVAL consteval
+#else
+#define CR_CONSTEVAL constexpr
+#endif
+
+namespace cashregister {
+
+// *** Scale Factors
+// Number of minor units within a single unit of currency, folded to a constant per decimal count
+template <unsigned Decimals>
+struct Scale {
+	static constexpr ::Currency factor = 10 * Scale<Decimals-1>::factor;
+};
+
+template <>
+struct Scale<0> {
+	static constexpr ::Currency factor = 1;
+};
+
+// *** Currency Symbols
+inline constexpr char USD_SYM[] = CURRENCY_SYM;
+inline constexpr char JPY_SYM[] = "\xC2\xA5";
+inline constexpr char BHD_SYM[] = "BD";
+
+/**
+An amount of currency with a fixed number of decimal places, stored as a count of
+	its smallest unit. See docs/data.md for the text representations
+@param Decimals
+	The number of decimal digits following the units portion
+@param Symbol
+	The currency symbol, as printed before and optionally scanned before an amount
+*/
+template <unsigned Decimals, const char *Symbol>
+class Currency {
+public:
+	static constexpr unsigned decimals = Decimals;
+	static constexpr ::Currency scale = Scale<Decimals>::factor;
+	static constexpr std::string_view symbol = Symbol;
+
+	constexpr Currency() : m_minor(0) {}
+
+	// Construct an amount from a count of the smallest unit, ie: cents
+	static constexpr Currency from_minor(::Currency minor) {
+		return Currency(minor);
+	}
+
+	constexpr ::Currency minor() const { return m_minor; }
+	constexpr ::Currency units() const { return m_minor / scale; }
+	constexpr ::Currency fraction() const { return m_minor % scale; }
+
+	// *** Scanning
+	/**
+	Scan a string for the representation of an amount of currency
+	@param in
+		The string to be scanned, formatted as [SYM]N[.N][xN]
+	@return
+		The amount of currency represented in the string
+	@throws std::invalid_argument
+		If the string is malformed, carries more decimals than the currency
+		allows, or its value does not fit within a Currency
+	*/
+	static constexpr Currency parse(std::string_view in) {
+		std::size_t i = 0;
+		// Skip whitespace
+		while (i < in.size() && s_is_space(in[i]))
+			i++;
+		// Skip currency symbol
+		if (in.substr(i, symbol.size()) == symbol)
+			i += symbol.size();
+		if (i >= in.size() || !s_is_digit(in[i]))
+			throw std::invalid_argument("currency must begin with a digit");
+
+		::Currency units = s_get_number(in, i);
+		::Currency fraction = 0;
+		if (i < in.size() && in[i] == '.') {
+			if (Decimals == 0)
+				throw std::invalid_argument("currency has no decimal portion");
+			i++;
+			::Currency base = scale / 10;
+			for (; i < in.size() && s_is_digit(in[i]); i++) {
+				if (base == 0)
+					throw std::invalid_argument("too many decimal digits");
+				fraction += base * (in[i] - '0');
+				base /= 10;
+			}
+		}
+		::Currency multiplier = 1;
+		if (i < in.size() && (in[i] == 'x' || in[i] == 'X')) {
+			i++;
+			if (i >= in.size() || !s_is_digit(in[i]))
+				throw std::invalid_argument("multiplier must be a whole number");
+			multiplier = s_get_number(in, i);
+		}
+		if (i != in.size())
+			throw std::invalid_argument("excess characters after currency");
+
+		::Currency out = s_checked_mul(units, scale);
+		out = s_checked_add(out, fraction);
+		return Currency(s_checked_mul(out, multiplier));
+	}
+
+	// *** Printing
+	/**
+	Write the printed representation of the amount, as $N,NNN.NN, to an output iterator.
+		Digits are emitted in pairs from a lookup table; nothing is allocated
+	@param out
+		The iterator to which characters are written
+	@return
+		The iterator past the last character written
+	*/
+	template <class OutputIt>
+	OutputIt format_to(OutputIt out) const {
+		for (char c : symbol)
+			*out++ = c;
+		// Split the units into groups of 3 digits, least significant first; 2^64 has 7 groups
+		unsigned groups[7];
+		int n = 0;
+		::Currency units = this->units();
+		do {
+			groups[n++] = units % 1000;
+			units /= 1000;
+		} while (units > 0);
+		// The leading group is unpadded, all others are padded and preceded by a comma
+		unsigned lead = groups[--n];
+		if (lead >= 100)
+			out = s_write_triple(out, lead);
+		else if (lead >= 10)
+			out = s_write_pair(out, lead);
+		else
+			*out++ = '0' + lead;
+		while (n > 0) {
+			*out++ = ',';
+			out = s_write_triple(out, groups[--n]);
+		}
+		if constexpr (Decimals > 0) {
+			*out++ = '.';
+			::Currency fraction = this->fraction(), div = scale;
+			unsigned d = Decimals;
+			if (d % 2) {
+				div /= 10;
+				*out++ = '0' + fraction / div;
+				fraction %= div;
+				d--;
+			}
+			for (; d > 0; d -= 2) {
+				div /= 100;
+				out = s_write_pair(out, fraction / div);
+				fraction %= div;
+			}
+		}
+		return out;
+	}
+
+	/**
+	Convert the amount into its printed representation, as $N,NNN.NN
+	@return
+		The printed representation, with its decimal portion padded
+	*/
+	std::string to_string() const {
+		std::string out;
+		format_to(std::back_inserter(out));
+		return out;
+	}
+
+	// *** Arithmetic
+	constexpr Currency &operator+=(Currency other) {
+		m_minor += other.m_minor;
+		return *this;
+	}
+
+	constexpr Currency &operator*=(::Currency multiplier) {
+		m_minor *= multiplier;
+		return *this;
+	}
+
+	friend constexpr Currency operator+(Currency a, Currency b) { return a += b; }
+	friend constexpr Currency operator*(Currency a, ::Currency m) { return a *= m; }
+	friend constexpr Currency operator*(::Currency m, Currency a) { return a *= m; }
+
+	// Apply a percentage to the amount, truncating any partial minor unit
+	constexpr Currency percent(Percent p) const {
+		return Currency(m_minor * p / 100);
+	}
+
+	friend constexpr bool operator==(Currency a, Currency b) { return a.m_minor == b.m_minor; }
+	friend constexpr bool operator!=(Currency a, Currency b) { return a.m_minor != b.m_minor; }
+	friend constexpr bool operator<(Currency a, Currency b) { return a.m_minor < b.m_minor; }
+	friend constexpr bool operator>(Currency a, Currency b) { return a.m_minor > b.m_minor; }
+	friend constexpr bool operator<=(Currency a, Currency b) { return a.m_minor <= b.m_minor; }
+	friend constexpr bool operator>=(Currency a, Currency b) { return a.m_minor >= b.m_minor; }
+
+private:
+	::Currency m_minor;
+
+	constexpr explicit Currency(::Currency minor) : m_minor(minor) {}
+
+	static constexpr char s_digit_pairs[] =
+		"00010203040506070809" "10111213141516171819" "20212223242526272829"
+		"30313233343536373839" "40414243444546474849" "50515253545556575859"
+		"60616263646566676869" "70717273747576777879" "80818283848586878889"
+		"90919293949596979899";
+
+	template <class OutputIt>
+	static OutputIt s_write_pair(OutputIt out, unsigned v) {
+		*out++ = s_digit_pairs[2*v];
+		*out++ = s_digit_pairs[2*v + 1];
+		return out;
+	}
+
+	template <class OutputIt>
+	static OutputIt s_write_triple(OutputIt out, unsigned v) {
+		*out++ = '0' + v / 100;
+		return s_write_pair(out, v % 100);
+	}
+
+	static constexpr bool s_is_digit(char c) { return c >= '0' && c <= '9'; }
+	static constexpr bool s_is_space(char c) {
+		return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+	}
+
+	static constexpr ::Currency s_checked_add(::Currency a, ::Currency b) {
+		if (a + b < a)
+			throw std::invalid_argument("currency out of range");
+		return a + b;
+	}
+
+	static constexpr ::Currency s_checked_mul(::Currency a, ::Currency b) {
+		if (b != 0 && a > (::Currency) -1 / b)
+			throw std::invalid_argument("currency out of range");
+		return a * b;
+	}
+
+	// Consume a run of decimal digits starting at in[i]
+	static constexpr ::Currency s_get_number(std::string_view in, std::size_t &i) {
+		::Currency out = 0;
+		for (; i < in.size() && s_is_digit(in[i]); i++)
+			out = s_checked_add(s_checked_mul(out, 10), in[i] - '0');
+		return out;
+	}
+};
+
+// *** Common Currencies
+using Jpy = Currency<0, JPY_SYM>;
+using Usd = Currency<2, USD_SYM>;
+using Bhd = Currency<3, BHD_SYM>;
+
+// The C interface stores USD cents; its raw values convert freely to and from Usd
+inline constexpr Usd from_c(::Currency amount) { return Usd::from_minor(amount); }
+inline constexpr ::Currency to_c(Usd amount) { return amount.minor(); }
+
+// *** Literals
+// Malformed literals, such as "9.071"_usd, fail to compile: the literal operators are
+// 	consteval under C++20, which the repo builds with. Code built as C++17 gets constexpr
+// 	operators instead, so a malformed literal there fails to compile only within a
+// 	constant expression, and elsewhere throws as parse does
+namespace literals {
+	CR_CONSTEVAL Jpy operator""_jpy(const char *s, std::size_t n) { return Jpy::parse({s, n}); }
+	CR_CONSTEVAL Usd operator""_usd(const char *s, std::size_t n) { return Usd::parse({s, n}); }
+	CR_CONSTEVAL Bhd operator""_bhd(const char *s, std::size_t n) { return Bhd::parse({s, n}); }
+}
+
+}  // namespace cashregister
+
+// *** Formatters
+// Produces the printed representation through {fmt}, whenever it is installed, accepting only
+// 	an empty format spec, as in "{}"; code using it links -lfmt
+#if __has_include(<fmt/format.h>)
+#include <fmt/format.h>
+
+template <unsigned Decimals, const char *Symbol>
+struct fmt::formatter<cashregister::Currency<Decimals, Symbol>, char> {
+	constexpr auto parse(fmt::format_parse_context &ctx) {
+		auto it = ctx.begin();
+		if (it != ctx.end() && *it != '}')
+			throw fmt::format_error("Currency takes no format spec");
+		return it;
+	}
+
+	template <class FormatContext>
+	auto format(const cashregister::Currency<Decimals, Symbol> &amount, FormatContext &ctx) const {
+		return amount.format_to(ctx.out());
+	}
+};
+#endif
+
+#endif
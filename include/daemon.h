@@ -0,0 +1,70 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils.h"
+#include "io.h"
+#include "wire.h"
+
+
+#ifndef DAEMON_H
+#define DAEMON_H
+
+// *** Constants
+#define DAEMON_BACKLOG      128
+#define DAEMON_MAX_EVENTS    64
+#define DAEMON_IN_SIZE     4096
+#define DAEMON_OUT_SIZE   16384
+#define DAEMON_MIN_REGISTERS 64
+
+// *** Type Definitions
+// Connections speak text lines until their first byte shows otherwise; see wire.h
+typedef enum {
+	SESSION_NEW,
+	SESSION_TEXT,
+	SESSION_BINARY
+} SessionMode;
+
+// A single connection to the daemon. Text sessions keep their own running total, while
+// 	binary sessions add to the totals of the registers named in each frame
+typedef struct Session {
+	int fd;
+	SessionMode mode;
+	Currency total;
+	bool discarding;          // Set while skipping the rest of an overlong line
+	bool writing;             // Whether epoll waits for output to drain, rather than for input
+	struct Session *prev;     // Neighbours in the list of open sessions
+	struct Session *next;
+	size_t in_len;
+	size_t out_len;
+	size_t out_sent;
+	char in[DAEMON_IN_SIZE];
+	char out[DAEMON_OUT_SIZE];
+} Session;
+
+// Running total of a register session submitted over the binary protocol
+typedef struct {
+	uint32 id;
+	bool used;
+	Currency total;
+} RegisterTotal;
+
+// The sessions a daemon serves, the socket on which it accepts new ones, and the totals
+// 	of the registers its binary sessions submit to
+typedef struct {
+	int epfd;
+	int listen_fd;            // -1 if sessions are only added with daemon_add
+	const char *path;         // Path of the listening socket, removed on close
+	Session *sessions;        // Every open session, so those left are closed with the daemon
+	RegisterTotal *registers; // Open-addressed table keyed by register ID
+	size_t register_count;
+	size_t register_capacity;
+} Daemon;
+
+// *** Public Interface
+void daemon_open(Daemon*, const char*);
+bool daemon_add(Daemon*, int);
+int daemon_poll(Daemon*, int);
+void daemon_close(Daemon*);
+int daemon_run(const char*);
+
+#endif
@@ -0,0 +1,27 @@
+#include <stddef.h>
+
+#include "utils.h"
+
+
+#ifndef FENWICK_H
+#define FENWICK_H
+
+// *** Constants
+#define FENWICK_MIN_CAPACITY 64
+
+// *** Type Definitions
+// Binary indexed tree of currency values; sums wrap, so subtracting x may be done by adding -x
+typedef struct {
+	Currency *tree;    // 1-indexed; tree[i] holds the sum of the lowbit(i) values ending at i
+	size_t count;
+	size_t capacity;
+} Fenwick;
+
+// *** Public Interface
+void fenwick_init(Fenwick*);
+void fenwick_append(Fenwick*, Currency);
+void fenwick_add(Fenwick*, size_t, Currency);
+Currency fenwick_prefix(const Fenwick*, size_t);
+void fenwick_free(Fenwick*);
+
+#endif
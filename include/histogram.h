@@ -0,0 +1,34 @@
+#include <stdio.h>
+#include <stddef.h>
+
+#include "utils.h"
+
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+// *** Constants
+#define HISTOGRAM_SUB_BITS  3       // Each power of two is split into 2^3 buckets
+#define HISTOGRAM_BUCKETS   ((64 - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS)
+#define HISTOGRAM_BATCH     256
+
+// *** Type Definitions
+// Exact counts of amounts in log-linear buckets, as in HDR histograms: amounts below
+// 	2^(SUB_BITS+1) cents have a bucket each, and every power of two above is split into
+// 	2^SUB_BITS buckets, so no bucket is wider than 1/8 of its lower bound
+typedef struct {
+	uint64 count;
+	uint64 buckets[HISTOGRAM_BUCKETS];
+} Histogram;
+
+// *** Public Interface
+void histogram_init(Histogram*);
+size_t histogram_index(Currency);
+void histogram_add(Histogram*, Currency);
+void histogram_add_batch(Histogram*, const Currency*, size_t);
+void histogram_merge(Histogram*, const Histogram*);
+Currency histogram_floor(size_t);
+Currency histogram_ceiling(size_t);
+void histogram_dump(const Histogram*, FILE*, const char*);
+
+#endif
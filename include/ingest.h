@@ -0,0 +1,69 @@
+#include <linux/io_uring.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "utils.h"
+
+
+#ifndef INGEST_H
+#define INGEST_H
+
+// *** Constants
+#define INGEST_DEPTH 4      // Reads kept in flight at once
+
+// *** Type Definitions
+typedef enum {
+	INGEST_AUTO,            // io_uring where the kernel allows it, else pread
+	INGEST_PREAD,
+	INGEST_URING
+} IngestMode;
+
+// Mapped submission and completion queues of an io_uring instance
+typedef struct {
+	int fd;
+	unsigned *sq_tail;
+	unsigned *sq_mask;
+	unsigned *sq_array;
+	unsigned *cq_head;
+	unsigned *cq_tail;
+	unsigned *cq_mask;
+	struct io_uring_sqe *sqes;
+	struct io_uring_cqe *cqes;
+	void *sq_ptr;
+	void *cq_ptr;
+	size_t sq_len;
+	size_t cq_len;
+	size_t sqes_len;
+} Uring;
+
+// A read of the file, handed back to the caller in the order it was submitted
+typedef struct {
+	int buffer;
+	char *addr;
+	size_t len;
+	off_t offset;
+	bool done;
+	ssize_t result;
+} IngestRead;
+
+// Sequential reader of a file keeping several reads in flight
+typedef struct {
+	int fd;
+	IngestMode mode;        // INGEST_PREAD or INGEST_URING once initialized
+	bool fixed;             // Whether the buffers were registered with the kernel
+	bool stream;            // Whether the file is a pipe or similar, read in order without offsets
+	off_t offset;           // File offset of the next read submitted
+	Uring ring;
+	IngestRead reads[INGEST_DEPTH];
+	size_t head;
+	size_t count;
+} Ingest;
+
+// *** Public Interface
+bool ingest_init(Ingest*, int, IngestMode, char**, size_t, size_t);
+bool ingest_submit(Ingest*, int, char*, size_t);
+int ingest_wait(Ingest*, ssize_t*);
+void ingest_close(Ingest*);
+
+#endif
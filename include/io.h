@@ -13,11 +13,18 @@
 #define CURRENCY_SYM "$"
 
 // *** Public Interface
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // Currency IO
 char *sprint_currency(char*, size_t, char*, Currency);
+int sprint_currency_r(char*, size_t, Currency);
 FILE *fprint_currency(FILE*, char*, Currency);
 void print_currency(char*, Currency);
 Currency sscan_currency(char*);
+Currency sscan_line_item(char*, unsigned*);
+Currency sscann_line_item(const char*, size_t, unsigned*);
 Currency fscan_currency(FILE*);
 Currency scan_currency(void);
 
@@ -29,4 +36,8 @@ Percent sscan_percent(char*);
 Percent fscan_percent(FILE*);
 Percent scan_percent(void);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
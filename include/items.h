@@ -0,0 +1,42 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils.h"
+#include "fenwick.h"
+#include "rollup.h"
+
+
+#ifndef ITEMS_H
+#define ITEMS_H
+
+// *** Constants
+#define ITEMS_MIN_CAPACITY 64
+
+// *** Type Definitions
+typedef enum {
+	ITEM_SALE,
+	ITEM_VOID
+} ItemType;
+
+// Line items of a tab, stored as parallel arrays so each field can be scanned on its own
+typedef struct {
+	Currency *amounts;     // Extended amounts, multiplier applied
+	uint32 *multipliers;
+	uint8 *types;          // ItemType of each item
+	uint64 *times;         // Nanoseconds since the epoch at which each item was entered
+	Fenwick totals;        // Amounts of items that are not void, for O(log n) subtotals
+	Rollups rollups;       // Sales by minute, hour and day, for O(1) period totals
+	size_t count;
+	size_t capacity;
+} ItemStore;
+
+// *** Public Interface
+void items_init(ItemStore*);
+size_t items_push(ItemStore*, Currency, uint32, ItemType);
+bool items_void(ItemStore*, size_t);
+bool items_edit(ItemStore*, size_t, Currency, uint32);
+Currency items_subtotal(const ItemStore*, size_t);
+size_t items_tally(const ItemStore*, ItemType, Currency*);
+void items_free(ItemStore*);
+
+#endif
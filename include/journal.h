@@ -0,0 +1,31 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils.h"
+#include "topk.h"
+
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+// *** Constants
+#define JOURNAL_MAP_BATCH     4096          // Lines scanned between sums of a mapped journal
+#define JOURNAL_RELEASE_SIZE  (8 << 20)     // Chars consumed before their pages are released
+#define JOURNAL_PRINT_SIZE    1024          // Chars preceding an offset that fingerprint it
+
+// *** Type Definitions
+// Result of totalling a journal: one entry per line, scanned as in the REPL
+typedef struct {
+	Currency total;
+	uint64 lines;
+	bool overflowed;        // Whether the total exceeded a Currency, leaving only its low 64 bits
+} JournalTotal;
+
+// *** Public Interface
+size_t journal_parse(const char*, size_t, bool, Currency*, size_t, size_t*);
+bool journal_total_mapped(int, JournalTotal*, TopK*);
+bool journal_append(int, const char*, size_t);
+uint64 journal_fingerprint(const char*, size_t, uint64);
+bool journal_fingerprint_fd(int, uint64, uint64*);
+
+#endif
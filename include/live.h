@@ -0,0 +1,54 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils.h"
+#include "catalog.h"
+
+
+#ifndef LIVE_H
+#define LIVE_H
+
+// *** Constants
+#define LIVE_MAX_READERS 64
+
+// *** Type Definitions
+// A reader's announcement of the epoch in which it began reading, or 0 while it holds no
+// 	catalog; each on its own cache line, as readers write theirs on every lookup
+typedef struct {
+	_Alignas(CACHE_LINE_SIZE) atomic_uint_fast64_t epoch;
+} LiveReader;
+
+// A replaced catalog, freed once no reader can still hold it
+typedef struct LiveRetired {
+	Catalog *catalog;
+	uint64 epoch;           // The epoch begun by its replacement; readers announcing it or later never saw it
+	struct LiveRetired *next;
+} LiveRetired;
+
+// The current catalog, replaced whole while readers go on looking products up. A new
+// 	catalog is built aside, then published by swapping the pointer and beginning a new
+// 	epoch. Readers announce the epoch they read in, so the catalog replaced is freed once
+// 	every reader has announced a later epoch or finished reading. Reading takes two
+// 	loads and a store, and never waits; only writers take the lock
+typedef struct {
+	_Alignas(CACHE_LINE_SIZE) _Atomic(Catalog*) current;
+	atomic_uint_fast64_t epoch;
+	atomic_size_t registered;
+	LiveReader readers[LIVE_MAX_READERS];
+	pthread_mutex_t lock;   // Serializes writers, and guards retired
+	LiveRetired *retired;
+} LiveCatalog;
+
+// *** Public Interface
+bool live_init(LiveCatalog*, const char*);
+LiveReader *live_register(LiveCatalog*);
+const Catalog *live_enter(LiveCatalog*, LiveReader*);
+void live_exit(LiveReader*);
+void live_publish(LiveCatalog*, Catalog*);
+bool live_reload(LiveCatalog*, const char*);
+size_t live_reclaim(LiveCatalog*);
+void live_free(LiveCatalog*);
+
+#endif
@@ -0,0 +1,52 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils.h"
+
+
+#ifndef MPSC_H
+#define MPSC_H
+
+// *** Constants
+#define MPSC_BATCH_SIZE 256
+
+// *** Type Definitions
+// A slot's sequence number tells producers and the consumer whose turn it is to use the slot
+typedef struct {
+	atomic_size_t seq;
+	Currency value;
+} MpscCell;
+
+// Bounded lock-free ring of currency entries, for any number of producers and one consumer
+typedef struct {
+	_Alignas(CACHE_LINE_SIZE) atomic_size_t tail;     // Next position claimed by a producer
+	_Alignas(CACHE_LINE_SIZE) atomic_size_t head;     // Next position read by the consumer; producers may read it
+	_Alignas(CACHE_LINE_SIZE) atomic_ulong rejected;  // Pushes refused because the ring was full
+	MpscCell *cells;
+	size_t mask;
+} MpscRing;
+
+// Consumer thread applying a ring's entries to a running total
+typedef struct {
+	MpscRing *ring;
+	atomic_ulong total;
+	atomic_ulong applied;     // Number of entries applied so far
+	atomic_bool stopping;
+	pthread_t thread;
+} MpscAggregator;
+
+// *** Public Interface
+// Ring
+bool mpsc_init(MpscRing*, size_t);
+bool mpsc_push(MpscRing*, Currency);
+size_t mpsc_pop_batch(MpscRing*, Currency*, size_t);
+size_t mpsc_size(MpscRing*);
+void mpsc_free(MpscRing*);
+
+// Aggregator
+bool mpsc_aggregator_start(MpscAggregator*, MpscRing*);
+Currency mpsc_aggregator_stop(MpscAggregator*);
+
+#endif
@@ -0,0 +1,51 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils.h"
+#include "ingest.h"
+#include "journal.h"
+#include "spsc.h"
+#include "topk.h"
+
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+// *** Constants
+#define PIPELINE_BUFFERS          8
+#define PIPELINE_BUFFER_SIZE (1 << 20)
+#define PIPELINE_CARRY_SIZE    4096   // Room ahead of each read for the line carried from the last
+#define PIPELINE_BATCHES          8
+#define PIPELINE_BATCH_SIZE    4096
+
+// *** Type Definitions
+// Chars read from the journal, always ending on a line boundary; len 0 marks the end of input.
+// 	Reads land past the first PIPELINE_CARRY_SIZE bytes of base, and data begins where
+// 	the partial line carried over from the previous buffer was placed
+typedef struct {
+	size_t len;
+	char *data;
+	char *base;
+} PipelineBuffer;
+
+// Amounts scanned from consecutive lines; the batch marked last ends the journal
+typedef struct {
+	size_t count;
+	bool last;
+	Currency amounts[PIPELINE_BATCH_SIZE];
+} PipelineBatch;
+
+// Reader, parser and aggregator stages, passing recycled buffers and batches around rings
+typedef struct {
+	Ingest ingest;
+	bool failed;                   // Set by the reader if the journal could not be read
+	SpscRing filled, empty;        // Buffers from the reader to the parser, and back
+	SpscRing parsed, spent;        // Batches from the parser to the aggregator, and back
+	PipelineBuffer buffers[PIPELINE_BUFFERS];
+	PipelineBatch *batches;
+} Pipeline;
+
+// *** Public Interface
+bool pipeline_total(int, IngestMode, JournalTotal*, TopK*);
+
+#endif
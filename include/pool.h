@@ -0,0 +1,57 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils.h"
+
+
+#ifndef POOL_H
+#define POOL_H
+
+// *** Constants
+#define POOL_MIN_TASKS 64
+#define POOL_SPINS     64       // Times an idle worker looks for a task before it sleeps
+
+// *** Type Definitions
+struct Pool;
+typedef void (*PoolTaskFn)(struct Pool*, void*);
+
+typedef struct {
+	PoolTaskFn fn;
+	void *arg;
+} PoolTask;
+
+// A worker's tasks; the worker takes from the tail, while thieves take from the head
+typedef struct {
+	_Alignas(CACHE_LINE_SIZE) pthread_mutex_t lock;
+	PoolTask *tasks;
+	size_t head;
+	size_t tail;
+	size_t capacity;
+} PoolDeque;
+
+// Fixed set of worker threads, each with its own deque, stealing from one another when idle.
+// 	A worker that finds no task for a while sleeps until one is submitted
+typedef struct Pool {
+	PoolDeque *deques;
+	pthread_t *threads;
+	size_t workers;
+	atomic_size_t pending;      // Tasks submitted but not yet finished
+	atomic_size_t queued;       // Tasks submitted but not yet taken by a worker
+	atomic_size_t sleepers;     // Workers asleep, or about to sleep, on wake
+	atomic_size_t next;         // Round-robin deque for tasks submitted from outside the pool
+	atomic_size_t started;      // Workers that have taken their index
+	atomic_bool stopping;
+	pthread_mutex_t idle_lock;  // Guards sleeping on wake and waiting on done
+	pthread_cond_t wake;        // Signalled when a task is submitted to a pool with sleepers
+	pthread_cond_t done;        // Broadcast when the last pending task finishes
+} Pool;
+
+// *** Public Interface
+Pool *pool_create(size_t);
+void pool_submit(Pool*, PoolTaskFn, void*);
+void pool_wait(Pool*);
+void pool_destroy(Pool*);
+
+#endif
@@ -0,0 +1,45 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils.h"
+
+
+#ifndef PREFIX_H
+#define PREFIX_H
+
+// *** Constants
+#define PREFIX_MAGIC          0x58495243    // "CRIX", little-endian
+#define PREFIX_VERSION        3
+#define PREFIX_DEFAULT_STRIDE 4096
+#define PREFIX_MIN_CAPACITY   64
+#define PREFIX_SUFFIX         ".idx"
+
+// *** Type Definitions
+// Where entry k * stride of a journal begins, and the sum of every entry before it
+typedef struct {
+	uint64 offset;
+	Currency sum;
+} PrefixSample;
+
+// Sidecar index of a journal's running total, sampled every stride entries; see docs/data.md
+typedef struct {
+	uint32 stride;
+	uint64 entries;     // Complete lines indexed so far
+	uint64 covered;     // Chars of the journal indexed so far, always ending on a newline
+	uint64 fingerprint; // Of the chars covered, by journal_fingerprint, so rewrites are caught
+	Currency total;     // Sum of every indexed entry
+	PrefixSample *samples;
+	size_t count;
+	size_t capacity;
+} PrefixIndex;
+
+// *** Public Interface
+void prefix_init(PrefixIndex*, uint32);
+bool prefix_update(PrefixIndex*, const char*, size_t);
+bool prefix_total(const PrefixIndex*, const char*, uint64, Currency*);
+bool prefix_range(const PrefixIndex*, const char*, uint64, uint64, Currency*);
+bool prefix_load(PrefixIndex*, const char*);
+bool prefix_save(const PrefixIndex*, const char*);
+void prefix_free(PrefixIndex*);
+
+#endif
@@ -0,0 +1,41 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "utils.h"
+
+
+#ifndef PUBLISH_H
+#define PUBLISH_H
+
+// *** Constants
+#define PUBLISH_DEFAULT_NAME "/" PROGRAM_TITLE
+
+// *** Type Definitions
+// Layout of the shared memory segment. Fields are only consistent with each other
+// 	when seq is even and unchanged across the read; see publish_read
+typedef struct {
+	_Alignas(CACHE_LINE_SIZE) atomic_ulong seq;
+	atomic_ulong total;
+	atomic_ulong count;
+	atomic_ulong updated_ns;    // CLOCK_REALTIME of the last update, in nanoseconds
+} PublishedTotal;
+
+// A consistent copy of the published fields
+typedef struct {
+	Currency total;
+	uint64 count;
+	uint64 updated_ns;
+} TotalSnapshot;
+
+// *** Public Interface
+// Register
+PublishedTotal *publish_open(const char*);
+void publish_update(PublishedTotal*, Currency, uint64);
+void publish_close(PublishedTotal*, const char*);
+
+// Readers
+const PublishedTotal *publish_attach(const char*);
+TotalSnapshot publish_read(const PublishedTotal*);
+void publish_detach(const PublishedTotal*);
+
+#endif
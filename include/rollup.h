@@ -0,0 +1,51 @@
+#include <stddef.h>
+
+#include "utils.h"
+
+
+#ifndef ROLLUP_H
+#define ROLLUP_H
+
+// *** Constants
+#define ROLLUP_NS_PER_SEC   1000000000UL
+#define ROLLUP_MAX_BUCKETS  60
+#define ROLLUP_MINUTES      60      // Buckets kept per period, ie: the last 60 minutes
+#define ROLLUP_HOURS        48
+#define ROLLUP_DAYS         31
+
+// *** Type Definitions
+typedef enum {
+	ROLLUP_MINUTE,
+	ROLLUP_HOUR,
+	ROLLUP_DAY,
+	ROLLUP_PERIODS
+} RollupPeriod;
+
+// Sales within one period, numbered from the epoch in local time
+typedef struct {
+	uint64 period;
+	Currency total;
+	uint64 count;
+} RollupBucket;
+
+// The most recent periods of one length, each in the slot period % size
+typedef struct {
+	uint64 width;           // Nanoseconds per period
+	size_t size;
+	RollupBucket buckets[ROLLUP_MAX_BUCKETS];
+} RollupRing;
+
+// Running totals by minute, hour and day, updated as each sale is entered
+typedef struct {
+	long offset;            // Nanoseconds east of UTC, so days begin at local midnight
+	RollupRing rings[ROLLUP_PERIODS];
+} Rollups;
+
+// *** Public Interface
+void rollup_init(Rollups*);
+uint64 rollup_now(void);
+void rollup_add(Rollups*, uint64, Currency, int);
+RollupBucket rollup_get(const Rollups*, RollupPeriod, uint64);
+const char *rollup_period_name(RollupPeriod);
+
+#endif
@@ -0,0 +1,32 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils.h"
+
+
+#ifndef RUNNING_H
+#define RUNNING_H
+
+// *** Constants
+#define RUNNING_CHUNK_SIZE  (1 << 20)   // Chars of journal per chunk, extended to end on a line boundary
+#define RUNNING_WINDOW      4           // Chunks being formatted per worker, ahead of the one being written
+#define RUNNING_BATCH       4096
+
+// *** Type Definitions
+// Consecutive lines of a mapped journal. The first pass sums them; once the sums of all
+// 	preceding chunks are known, the second pass formats a running total after each line
+typedef struct {
+	const char *data;
+	size_t len;
+	Currency sum;           // Total of the chunk's own lines
+	Currency offset;        // Total of every line before the chunk
+	char *out;
+	size_t out_len;
+	atomic_bool done;       // Set once out holds the chunk's formatted lines
+} RunningChunk;
+
+// *** Public Interface
+bool running_totals(int, int, size_t);
+
+#endif
@@ -0,0 +1,36 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils.h"
+
+
+#ifndef SHARD_H
+#define SHARD_H
+
+// *** Constants
+#define SHARD_NONE ((size_t) -1)
+
+// *** Type Definitions
+// One thread's share of a total, alone on its cache line
+typedef struct {
+	_Alignas(CACHE_LINE_SIZE) atomic_ulong total;
+	atomic_ulong seq;       // Twice the number of amounts added; odd while an add is in progress
+} Shard;
+
+// A running total split across per-thread shards, combined only when read
+typedef struct {
+	Shard *shards;
+	size_t count;
+	atomic_size_t claimed;
+} ShardedTotal;
+
+// *** Public Interface
+bool shard_init(ShardedTotal*, size_t);
+size_t shard_claim(ShardedTotal*);
+void shard_add(ShardedTotal*, size_t, Currency);
+Currency shard_sum(ShardedTotal*);
+Currency shard_snapshot(ShardedTotal*, uint64*);
+void shard_free(ShardedTotal*);
+
+#endif
@@ -0,0 +1,30 @@
+#include <stddef.h>
+
+#include "utils.h"
+
+
+#ifndef SKETCH_H
+#define SKETCH_H
+
+// *** Constants
+#define SKETCH_K       256      // Amounts held per level; rank error shrinks as this grows
+#define SKETCH_LEVELS   32      // Level h holds amounts of weight 2^h
+
+// *** Type Definitions
+// Quantile sketch of currency amounts in fixed memory, after KLL: each full level is
+// 	sorted and every other amount is promoted to the level above at twice the weight.
+// 	Sketches of different registers or threads merge into one of all their amounts
+typedef struct {
+	uint64 count;                           // Amounts added, of any weight
+	uint64 seed;                            // Chooses which half of a level is promoted
+	uint16 sizes[SKETCH_LEVELS];
+	Currency levels[SKETCH_LEVELS][SKETCH_K];
+} Sketch;
+
+// *** Public Interface
+void sketch_init(Sketch*);
+void sketch_add(Sketch*, Currency);
+void sketch_merge(Sketch*, const Sketch*);
+Currency sketch_quantile(const Sketch*, double);
+
+#endif
@@ -0,0 +1,28 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils.h"
+
+
+#ifndef SPSC_H
+#define SPSC_H
+
+// *** Type Definitions
+// Bounded lock-free ring of pointers from exactly one producer thread to one consumer thread
+typedef struct {
+	_Alignas(CACHE_LINE_SIZE) atomic_size_t head;    // Next position read by the consumer
+	_Alignas(CACHE_LINE_SIZE) atomic_size_t tail;    // Next position written by the producer
+	_Alignas(CACHE_LINE_SIZE) void **slots;
+	size_t mask;
+} SpscRing;
+
+// *** Public Interface
+bool spsc_init(SpscRing*, size_t);
+bool spsc_push(SpscRing*, void*);
+void *spsc_pop(SpscRing*);
+void spsc_push_wait(SpscRing*, void*);
+void *spsc_pop_wait(SpscRing*);
+void spsc_free(SpscRing*);
+
+#endif
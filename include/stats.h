@@ -0,0 +1,46 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils.h"
+#include "sketch.h"
+#include "histogram.h"
+
+
+#ifndef STATS_H
+#define STATS_H
+
+// *** Constants
+#define STATS_MAGIC       0x4B435243    // "CRCK", little-endian
+#define STATS_VERSION     6
+#define STATS_INTERVAL    1024          // Entries accepted between checkpoints; at most these are rescanned on opening
+#define STATS_SUFFIX      ".ckpt"
+
+// *** Type Definitions
+// Aggregates of accepted entries, maintained as each is accepted so reports never rescan.
+// 	Entries are described as accepted; later voids and edits do not alter them
+typedef struct {
+	uint64 count;
+	Currency sum;
+	Currency min;
+	Currency max;
+	Histogram histogram;
+	Sketch quantiles;
+} Stats;
+
+// The chars of a journal that a checkpoint's aggregates cover. A journal replaced or
+// 	rewritten since no longer matches, and is rescanned from its start
+typedef struct {
+	uint64 offset;          // Chars covered, always ending on a newline
+	uint64 inode;
+	uint64 fingerprint;     // Of the chars covered, by journal_fingerprint
+} StatsMark;
+
+// *** Public Interface
+void stats_init(Stats*);
+void stats_add(Stats*, Currency);
+Currency stats_mean(const Stats*);
+size_t stats_scan(Stats*, const char*, size_t);
+bool stats_load(Stats*, StatsMark*, const char*);
+bool stats_save(const Stats*, const StatsMark*, const char*);
+
+#endif
@@ -0,0 +1,35 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils.h"
+
+
+#ifndef SUM_H
+#define SUM_H
+
+// *** Constants
+#define SUM_BLOCK       1024    // Amounts summed between overflow checks
+#define SUM_GUARD_BITS  10      // log2(SUM_BLOCK); a block whose amounts all clear these top bits cannot overflow
+
+// *** Type Definitions
+typedef enum {
+	SUM_AUTO,               // The widest kernel the processor supports
+	SUM_SCALAR,
+	SUM_SSE,
+	SUM_AVX2,
+	SUM_AVX512
+} SumKernel;
+
+// A 128-bit total of amounts, which cannot overflow for any array held in memory
+typedef struct {
+	Currency low;
+	uint64 high;
+} Sum;
+
+// *** Public Interface
+void sum_init(Sum*);
+bool sum_supported(SumKernel);
+void sum_amounts(Sum*, const Currency*, size_t, SumKernel);
+bool sum_fits(const Sum*);
+
+#endif
@@ -0,0 +1,36 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils.h"
+
+
+#ifndef TOPK_H
+#define TOPK_H
+
+// *** Constants
+#define TOPK_MAX 128
+
+// *** Type Definitions
+// An entry, and the 1-based number of the journal line it was scanned from
+typedef struct {
+	Currency amount;
+	uint64 line;
+} TopEntry;
+
+// The k largest entries seen, held in a min-heap so the smallest is replaced first.
+// 	Of equal amounts, the earliest line is kept
+typedef struct {
+	size_t k;
+	size_t count;
+	Currency threshold;         // Entries below this cannot enter; 0 until the heap is full
+	TopEntry heap[TOPK_MAX];
+} TopK;
+
+// *** Public Interface
+void topk_init(TopK*, size_t);
+void topk_offer(TopK*, Currency, uint64);
+void topk_offer_batch(TopK*, const Currency*, size_t, uint64);
+void topk_merge(TopK*, const TopK*, uint64);
+size_t topk_sorted(const TopK*, TopEntry*);
+
+#endif
@@ -7,6 +7,10 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+// *** Constants
+#define CACHE_LINE_SIZE 64
+
+
 // *** Type Definitions
 // Custom
 typedef unsigned long Currency;
@@ -24,4 +28,8 @@ typedef unsigned char  uint8;
 #define ERROR(msg) fprintf(stderr, "%s: %s\n", PROGRAM_TITLE, msg); exit(1)  // Fatal Errors
 #define NONF_ERROR(msg) fprintf(stderr, "%s\n", msg)  // Non-fatal Errors
 
+// Memory
+// Round a size up to whole cache lines, as aligned_alloc requires of cache-aligned blocks
+#define CACHE_LINE_ROUND(size) (((size) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE)
+
 #endif
@@ -0,0 +1,56 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils.h"
+
+
+#ifndef WIRE_H
+#define WIRE_H
+
+// *** Constants
+// The magic byte can never begin a line of text input, so the daemon can tell protocols apart
+#define WIRE_MAGIC       0xC7
+#define WIRE_VERSION        1
+#define WIRE_MAX_ENTRIES  255
+
+// *** Type Definitions
+// Every frame is a header followed by count entries; all fields are in host byte order
+typedef struct {
+	uint8 magic;
+	uint8 version;
+	uint16 count;
+	uint32 session;     // Register session the entries apply to
+} WireHeader;
+
+typedef enum {
+	WIRE_CURRENCY,      // Adds value * multiplier to the session total
+	WIRE_PERCENT        // Adds value percent of the session total, truncated
+} WireKind;
+
+typedef struct {
+	uint64 value;       // Currency or Percent, already scanned by the client
+	uint32 multiplier;
+	uint8 kind;         // WireKind
+	uint8 reserved[3];
+} WireEntry;
+
+// A frame being built by a client; only its first count entries are sent.
+// 	The daemon replies to each frame with a frame of 1 entry: the session's new total
+typedef struct {
+	WireHeader header;
+	WireEntry entries[WIRE_MAX_ENTRIES];
+} WireFrame;
+
+// *** Public Interface
+// Framing
+size_t wire_frame_size(const WireHeader*);
+bool wire_header_valid(const WireHeader*);
+
+// Client
+int wire_connect(const char*);
+void wire_frame_init(WireFrame*, uint32);
+bool wire_add_currency(WireFrame*, Currency, uint32);
+bool wire_add_percent(WireFrame*, Percent);
+bool wire_submit(int, WireFrame*, Currency*);
+
+#endif
@@ -0,0 +1,117 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+#include "utils.h"
+
+
+/******
+ * Static Functions (marked with s_ prefix)
+ ******/
+
+// Allocate a chunk able to hold at least n bytes
+static ArenaChunk *s_new_chunk(size_t n) {
+	ArenaChunk *chunk = malloc(sizeof(ArenaChunk) + n);
+	if (chunk == NULL) {
+		ERROR("Out of memory");
+	}
+	chunk->next = NULL;
+	chunk->size = n;
+	chunk->used = 0;
+	return chunk;
+}
+
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Prepare an empty arena; no memory is allocated until it is first used
+@param arena
+	A pointer to the arena to be initialized
+@param chunk_size
+	The minimum number of bytes requested from malloc at a time
+*/
+void arena_init(Arena *arena, size_t chunk_size) {
+	arena->head = NULL;
+	arena->current = NULL;
+	arena->chunk_size = chunk_size;
+}
+
+/**
+Allocate memory from an arena by bumping a pointer within its current chunk.
+	Chunks kept from before a reset are reused before any new chunk is allocated
+@param arena
+	A pointer to the arena to allocate from
+@param n
+	The number of bytes to allocate
+@return
+	A pointer to n bytes aligned to ARENA_ALIGN, valid until the next reset
+*/
+void *arena_alloc(Arena *arena, size_t n) {
+	ArenaChunk *chunk = arena->current;
+	n = (n + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1);
+	// Move along the chunk list until a chunk fits the request
+	while (chunk == NULL || chunk->size - chunk->used < n) {
+		ArenaChunk *next = chunk == NULL ? arena->head : chunk->next;
+		if (next == NULL || next->size < n) {
+			// Splice a new chunk in after the current one
+			next = s_new_chunk(n > arena->chunk_size ? n : arena->chunk_size);
+			if (chunk == NULL) {
+				next->next = arena->head;
+				arena->head = next;
+			}
+			else {
+				next->next = chunk->next;
+				chunk->next = next;
+			}
+		}
+		next->used = 0;
+		chunk = next;
+	}
+	arena->current = chunk;
+	void *out = chunk->data + chunk->used;
+	chunk->used += n;
+	return out;
+}
+
+/**
+Copy a string into an arena
+@param arena
+	A pointer to the arena to allocate from
+@param s
+	The string to be copied
+@return
+	A pointer to the copy, valid until the next reset
+*/
+char *arena_strdup(Arena *arena, const char *s) {
+	size_t len = strlen(s) + 1;
+	return memcpy(arena_alloc(arena, len), s, len);
+}
+
+/**
+Release every allocation made from an arena at once, keeping its chunks for reuse
+@param arena
+	A pointer to the arena to be reset
+*/
+void arena_reset(Arena *arena) {
+	if (arena->head != NULL)
+		arena->head->used = 0;
+	arena->current = arena->head;
+}
+
+/**
+Return all of an arena's chunks to the system
+@param arena
+	A pointer to the arena to be freed
+*/
+void arena_free(Arena *arena) {
+	ArenaChunk *chunk = arena->head, *next;
+	while (chunk != NULL) {
+		next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+	arena_init(arena, arena->chunk_size);
+}
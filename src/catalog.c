@@ -0,0 +1,713 @@
+#include <ctype.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "catalog.h"
+#include "io.h"
+#include "utils.h"
+
+
+#define RADIX_BITS 10           // Bucket bits sorted per pass when grouping SKUs
+#define FILL_AHEAD 16           // Entries located ahead of the one being written
+#define BUCKET_MAX 64           // Larger buckets are all but impossible; the hash is reseeded if one appears
+
+
+// Layout of a compiled catalog, followed by its pilots, remapped slots, entries and names,
+// 	each at an offset from the start of the file aligned to CATALOG_ALIGN
+typedef struct {
+	uint32 magic;
+	uint32 version;
+	uint64 seed;
+	uint64 count;
+	uint64 slots;
+	uint64 buckets;
+	uint64 pilots;
+	uint64 remap;
+	uint64 entries;
+	uint64 names;
+	uint64 names_len;
+	uint64 size;            // Of the whole file
+} CatalogImage;
+
+// A SKU scanned from a catalog, before it is placed
+typedef struct {
+	const char *sku;
+	Currency price;
+	uint32 name;
+	uint8 len;
+	bool dead;              // Whether a later line of the catalog redefines the SKU
+} PendingSku;
+
+// A SKU's hash, grouped with the others in its bucket so each bucket is read contiguously
+typedef struct {
+	uint64 hash;            // Chooses the SKU's bucket, and mixed, its slot
+	uint32 index;           // Of the SKU's PendingSku
+	uint32 bucket : 31;
+	uint32 dead : 1;
+} BucketedSku;
+
+
+/******
+ * Static Functions (marked with s_ prefix)
+ ******/
+
+// ***** Hashing
+
+// Murmur3's finalizer; a bijection, so distinct inputs stay distinct
+static inline uint64 s_mix(uint64 x) {
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdUL;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53UL;
+	x ^= x >> 33;
+	return x;
+}
+
+// Hash a SKU eight chars at a time
+static inline uint64 s_hash(const char *sku, size_t len, uint64 seed) {
+	uint64 h = seed ^ (len * 0x9e3779b97f4a7c15UL), w;
+	for (; len >= 8; sku += 8, len -= 8) {
+		memcpy(&w, sku, 8);
+		h = (h ^ w) * 0x9e3779b97f4a7c15UL;
+		h ^= h >> 32;
+	}
+	w = 0;
+	memcpy(&w, sku, len);
+	return s_mix((h ^ w) * 0x9e3779b97f4a7c15UL);
+}
+
+// Map a hash uniformly onto [0, n) without division
+static inline size_t s_range(uint64 hash, size_t n) {
+	return (size_t) (((unsigned __int128) hash * n) >> 64);
+}
+
+// Choose a SKU's bucket. As in PTHash, 60% of SKUs go to the first 30% of buckets, so
+// 	large buckets are placed while free slots are plentiful, and the last buckets
+// 	placed, into a crowded table, mostly hold a single SKU
+static inline size_t s_bucket(uint64 hash, size_t buckets) {
+	size_t dense = buckets * 3 / 10;
+	uint64 spread = hash * 0x9e3779b97f4a7c15UL;   // Independent of whether the SKU is dense
+	if (hash < 0x9999999999999999UL && dense > 0)
+		return s_range(spread, dense);
+	return dense + s_range(spread, buckets - dense);
+}
+
+static inline size_t s_position(uint64 mixed, uint32 pilot, size_t slots) {
+	return s_range(mixed ^ s_mix(pilot), slots);
+}
+
+// Find the entry of a SKU placed in a slot; the few slots past the entries are remapped
+static inline size_t s_entry(const Catalog *cat, uint64 mixed, uint32 pilot) {
+	size_t p = s_position(mixed, pilot, cat->slots);
+	return p < cat->count ? p : cat->remap[p - cat->count];
+}
+
+// ***** Scanning
+
+static bool s_is_sku_char(char c) {
+	return isalnum((unsigned char) c) || c == '-' || c == '_';
+}
+
+static bool s_is_blank(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Find the multiplier ending an input, as x or X followed by digits, storing the length
+// 	of what precedes it; returns 1 if there is none, or 0 if it is invalid
+static unsigned s_split_multiplier(const char *s, size_t len, size_t *head) {
+	size_t i = len;
+	while (i > 0 && isdigit((unsigned char) s[i-1]))
+		i--;
+	*head = len;
+	if (i == len || i < 2 || (s[i-1] != 'x' && s[i-1] != 'X'))
+		return 1;
+	*head = i - 1;
+	unsigned out = 0;
+	for (; i < len; i++)
+		out = out * 10 + (s[i] - '0');
+	return out;
+}
+
+// Check that a SKU could be entered: short enough, of valid chars, and not ending in
+// 	what would be scanned as a multiplier
+static bool s_is_valid_sku(const char *sku, size_t len) {
+	size_t head;
+	if (len == 0 || len > CATALOG_SKU_MAX)
+		return false;
+	for (size_t i = 0; i < len; i++) {
+		if (!s_is_sku_char(sku[i]))
+			return false;
+	}
+	s_split_multiplier(sku, len, &head);
+	return head == len;
+}
+
+// Scan one line of a text catalog, as SKU PRICE [NAME], interning its name; blank lines
+// 	leave len 0. Returns false if the line is invalid
+static bool s_scan_line(const char *p, const char *end, PendingSku *out, char *names, size_t *names_len) {
+	while (p < end && s_is_blank(*p))
+		p++;
+	out->sku = p;
+	while (p < end && !s_is_blank(*p))
+		p++;
+	out->len = p - out->sku < 256 ? p - out->sku : 255;
+	if (out->len == 0)
+		return true;
+	if (!s_is_valid_sku(out->sku, p - out->sku))
+		return false;
+	while (p < end && s_is_blank(*p))
+		p++;
+	const char *price = p;
+	unsigned multiplier;
+	while (p < end && !s_is_blank(*p))
+		p++;
+	out->price = sscann_line_item(price, p - price, &multiplier);
+	if (multiplier != 1)
+		return false;
+	while (p < end && s_is_blank(*p))
+		p++;
+	while (end > p && s_is_blank(end[-1]))
+		end--;
+	out->name = 0;
+	if (p < end) {
+		out->name = *names_len;
+		memcpy(names + *names_len, p, end - p);
+		*names_len += end - p;
+		names[(*names_len)++] = '\0';
+	}
+	return true;
+}
+
+// ***** Building
+
+// Sort SKUs by bucket, least significant digit first. Scattering each SKU straight to its
+// 	bucket writes all over a large array; each pass here writes to at most 2^RADIX_BITS
+// 	places, which stay in the caches
+static BucketedSku *s_sort_by_bucket(BucketedSku *items, BucketedSku *scratch, size_t n, size_t nb) {
+	for (unsigned shift = 0; (nb - 1) >> shift > 0; shift += RADIX_BITS) {
+		size_t counts[1 << RADIX_BITS] = {0}, at = 0;
+		for (size_t i = 0; i < n; i++)
+			counts[items[i].bucket >> shift & ((1 << RADIX_BITS) - 1)]++;
+		for (size_t d = 0; d < (1 << RADIX_BITS); d++) {
+			size_t count = counts[d];
+			counts[d] = at;
+			at += count;
+		}
+		for (size_t i = 0; i < n; i++)
+			scratch[counts[items[i].bucket >> shift & ((1 << RADIX_BITS) - 1)]++] = items[i];
+		BucketedSku *swap = items;
+		items = scratch;
+		scratch = swap;
+	}
+	return items;
+}
+
+static int s_compare_bucketed(const void *a, const void *b) {
+	const BucketedSku *x = a, *y = b;
+	if (x->hash != y->hash)
+		return x->hash < y->hash ? -1 : 1;
+	return x->index < y->index ? -1 : x->index > y->index;
+}
+
+// Order a bucket's SKUs by hash, then by line, so every definition of a SKU is adjacent,
+// 	its last definition last. Buckets are mostly a few SKUs, sorted by insertion; only
+// 	a SKU defined over and over makes one large
+static void s_sort_bucket(BucketedSku *items, size_t n) {
+	if (n > 16) {
+		qsort(items, n, sizeof(BucketedSku), s_compare_bucketed);
+		return;
+	}
+	for (size_t i = 1; i < n; i++) {
+		BucketedSku item = items[i];
+		size_t j = i;
+		for (; j > 0 && s_compare_bucketed(&items[j-1], &item) > 0; j--)
+			items[j] = items[j-1];
+		items[j] = item;
+	}
+}
+
+// Place every SKU with the catalog's seed, failing if the seed leaves two distinct SKUs
+// 	inseparable or some bucket without a pilot
+static bool s_place(Catalog *cat, PendingSku *keys, size_t n) {
+	size_t nb = n / CATALOG_LAMBDA + 1, live = n;
+	uint32 *start = calloc(nb + 1, sizeof(uint32)), *by_size = malloc(nb * sizeof(uint32));
+	uint32 sizes[BUCKET_MAX + 1] = {0};
+	uint64 *hashes = malloc(n * sizeof(uint64));
+	BucketedSku *order = malloc(n * sizeof(BucketedSku)), *scratch = malloc(n * sizeof(BucketedSku));
+	cat->pilots = calloc(nb, sizeof(uint16));
+	cat->remap = NULL;
+	if (start == NULL || by_size == NULL || hashes == NULL || order == NULL || scratch == NULL || cat->pilots == NULL) {
+		ERROR("Out of memory");
+	}
+	cat->buckets = nb;
+	cat->entries = NULL;
+	bool ok = true;
+
+	// Group SKUs by bucket
+	for (size_t i = 0; i < n; i++) {
+		hashes[i] = s_hash(keys[i].sku, keys[i].len, cat->seed);
+		keys[i].dead = false;
+		order[i] = (BucketedSku) {hashes[i], i, s_bucket(hashes[i], nb), false};
+	}
+	BucketedSku *sorted = s_sort_by_bucket(order, scratch, n, nb);
+	if (sorted != order) {
+		scratch = order;
+		order = sorted;
+	}
+	for (size_t i = 0; i < n; i++)
+		start[order[i].bucket + 1]++;
+	for (size_t b = 0; b < nb; b++)
+		start[b+1] += start[b];
+
+	// Drop all but the last definition of each SKU, then order buckets by size, largest first.
+	// 	Distinct SKUs sharing a hash would be inseparable, so they fail the seed
+	for (size_t b = 0; ok && b < nb; b++) {
+		size_t size = start[b+1] - start[b];
+		s_sort_bucket(order + start[b], size);
+		for (size_t i = start[b]; i + 1 < start[b+1]; i++) {
+			BucketedSku *x = &order[i], *y = &order[i+1];
+			if (x->hash != y->hash)
+				continue;
+			PendingSku *a = &keys[x->index], *c = &keys[y->index];
+			if (a->len != c->len || memcmp(a->sku, c->sku, a->len) != 0)
+				ok = false;
+			x->dead = a->dead = true;
+			live--;
+			size--;
+		}
+		if (size > BUCKET_MAX)
+			ok = false;
+		else
+			sizes[size]++;
+	}
+	for (size_t s = BUCKET_MAX, at = 0; ok && s <= BUCKET_MAX; s--) {
+		size_t count = sizes[s];
+		sizes[s] = at;
+		at += count;
+	}
+	for (size_t b = 0; ok && b < nb; b++) {
+		size_t size = 0;
+		for (size_t i = start[b]; i < start[b+1]; i++)
+			size += !order[i].dead;
+		by_size[sizes[size]++] = b;
+	}
+
+	// Search each bucket's pilot, marking the slots its SKUs take
+	size_t slots = live + live / CATALOG_SLACK + 1;
+	cat->count = live;
+	cat->slots = slots;
+	uint64 *taken = calloc(slots / 64 + 1, sizeof(uint64));
+	if (taken == NULL) {
+		ERROR("Out of memory");
+	}
+	for (size_t k = 0; ok && k < nb; k++) {
+		size_t b = by_size[k], pos[BUCKET_MAX], size = 0;
+		uint64 mixed[BUCKET_MAX];
+		uint32 pilot;
+		for (size_t i = start[b]; i < start[b+1]; i++) {
+			if (!order[i].dead)
+				mixed[size++] = s_mix(order[i].hash);
+		}
+		if (size == 0)
+			break;          // Every bucket after this is empty too
+		for (pilot = 0; pilot < CATALOG_MAX_PILOT; pilot++) {
+			size_t i;
+			for (i = 0; i < size; i++) {
+				pos[i] = s_position(mixed[i], pilot, slots);
+				if (taken[pos[i] / 64] >> (pos[i] % 64) & 1)
+					break;
+				size_t j = 0;
+				while (j < i && pos[j] != pos[i])
+					j++;
+				if (j < i)
+					break;
+			}
+			if (i == size)
+				break;
+		}
+		if (pilot == CATALOG_MAX_PILOT) {
+			ok = false;
+			break;
+		}
+		cat->pilots[b] = pilot;
+		for (size_t i = 0; i < size; i++)
+			taken[pos[i] / 64] |= 1UL << (pos[i] % 64);
+	}
+
+	// Send each slot taken past the entries to an entry whose slot went unused, so that
+	// 	there is exactly one entry per SKU
+	cat->remap = calloc(slots - live, sizeof(uint32));
+	if (cat->remap == NULL) {
+		ERROR("Out of memory");
+	}
+	for (size_t p = live, unused = 0; ok && p < slots; p++) {
+		if (!(taken[p / 64] >> (p % 64) & 1))
+			continue;
+		while (taken[unused / 64] >> (unused % 64) & 1)
+			unused++;
+		cat->remap[p - live] = unused++;
+	}
+
+	// Fill each SKU's entry. Entries are written in the order of the catalog, so each write
+	// 	misses; they are located ahead of time so the misses overlap. Hashes are reused
+	// 	for the locations
+	if (ok && (cat->entries = aligned_alloc(sizeof(CatalogEntry), (live + 1) * sizeof(CatalogEntry))) == NULL) {
+		ERROR("Out of memory");
+	}
+	for (size_t i = 0; ok && i < n; i++)
+		hashes[i] = keys[i].dead ? live : s_entry(cat, s_mix(hashes[i]), cat->pilots[s_bucket(hashes[i], nb)]);
+	for (size_t i = 0; ok && i < n; i++) {
+		if (i + FILL_AHEAD < n)
+			__builtin_prefetch(&cat->entries[hashes[i + FILL_AHEAD]], 1);
+		CatalogEntry e = {.price = keys[i].price, .name = keys[i].name, .len = keys[i].len};
+		memcpy(e.sku, keys[i].sku, keys[i].len);
+		cat->entries[hashes[i]] = e;    // The spare entry past the last takes dead SKUs
+	}
+	if (!ok) {
+		free(cat->pilots);
+		free(cat->remap);
+	}
+	free(taken);
+	free(start);
+	free(by_size);
+	free(hashes);
+	free(order);
+	free(scratch);
+	return ok;
+}
+
+// ***** Compiled Catalogs
+
+static uint64 s_align(uint64 offset) {
+	return (offset + CATALOG_ALIGN - 1) / CATALOG_ALIGN * CATALOG_ALIGN;
+}
+
+// Check that n items of a given width fit in a file of a given size from an aligned offset
+static bool s_fits(uint64 offset, uint64 n, uint64 width, uint64 size) {
+	return offset % CATALOG_ALIGN == 0 && offset <= size && n <= (size - offset) / width;
+}
+
+// Write chars to a file, then pad them with zeros up to the next aligned offset
+static bool s_write_section(FILE *file, const void *data, size_t len, uint64 *offset) {
+	static const char zeros[CATALOG_ALIGN] = {0};
+	uint64 end = s_align(*offset + len);
+	bool ok = fwrite(data, 1, len, file) == len
+			&& fwrite(zeros, 1, end - *offset - len, file) == end - *offset - len;
+	*offset = end;
+	return ok;
+}
+
+// Store each distinct name of a catalog once, rewriting the name offsets of a copy of its
+// 	entries to match; returns the interned names, of *len chars
+static char *s_intern_names(const Catalog *cat, CatalogEntry *entries, size_t *len) {
+	size_t capacity = 16;
+	while (capacity < 2 * (cat->count + 1))
+		capacity *= 2;
+	uint32 *table = calloc(capacity, sizeof(uint32));  // Offset + 1 of each name interned, or 0
+	char *names = malloc(cat->names_len);
+	if (table == NULL || names == NULL) {
+		ERROR("Out of memory");
+	}
+	names[0] = '\0';
+	*len = 1;
+	for (size_t i = 0; i < cat->count; i++) {
+		const char *name = cat->names + entries[i].name;
+		size_t name_len = strlen(name), h;
+		if (name_len == 0)
+			continue;
+		for (h = s_hash(name, name_len, 0) & (capacity - 1); table[h] != 0; h = (h + 1) & (capacity - 1)) {
+			if (strcmp(names + table[h] - 1, name) == 0)
+				break;
+		}
+		if (table[h] == 0) {
+			table[h] = *len + 1;
+			memcpy(names + *len, name, name_len + 1);
+			*len += name_len + 1;
+		}
+		entries[i].name = table[h] - 1;
+	}
+	free(table);
+	return names;
+}
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Build a catalog from its text, held in memory. Each line holds a SKU, its price and
+	optionally its name, separated by spaces or tabs; see docs/data.md. A SKU defined
+	more than once takes its last definition
+@param cat
+	A pointer to the catalog to be built
+@param data
+	The catalog's chars; they need not outlive the catalog
+@param len
+	The number of chars
+@return
+	False if any line is invalid, in which case nothing is left allocated
+*/
+bool catalog_build(Catalog *cat, const char *data, size_t len) {
+	const char *p = data, *end = data + len, *nl;
+	size_t lines = 1, n = 0;
+	for (nl = data; (nl = memchr(nl, '\n', end - nl)) != NULL; nl++)
+		lines++;
+	PendingSku *keys = malloc(lines * sizeof(PendingSku));
+	cat->names = malloc(len + 1);
+	if (keys == NULL || cat->names == NULL) {
+		ERROR("Out of memory");
+	}
+	cat->names[0] = '\0';   // Shared by every entry without a name
+	cat->names_len = 1;
+	cat->image = NULL;
+	bool ok = true;
+	while (ok && p < end) {
+		nl = memchr(p, '\n', end - p);
+		const char *line_end = nl != NULL ? nl : end;
+		ok = s_scan_line(p, line_end, &keys[n], cat->names, &cat->names_len);
+		if (ok && keys[n].len > 0)
+			n++;
+		p = line_end + 1;
+	}
+	for (uint64 seed = 0; ok && seed < CATALOG_MAX_SEEDS; seed++) {
+		cat->seed = s_mix(seed + 1);
+		if (s_place(cat, keys, n))
+			break;
+		if (seed + 1 == CATALOG_MAX_SEEDS)
+			ok = false;
+	}
+	free(keys);
+	if (!ok) {
+		free(cat->names);
+		return false;
+	}
+	char *names = realloc(cat->names, cat->names_len);
+	if (names != NULL)
+		cat->names = names;
+	return true;
+}
+
+/**
+Load a text catalog from a file
+@param cat
+	A pointer to the catalog to be loaded
+@param path
+	The path of the catalog file
+@return
+	False if the file could not be read, or any line of it is invalid
+*/
+bool catalog_load(Catalog *cat, const char *path) {
+	struct stat st;
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return false;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		return false;
+	}
+	char *data = NULL;
+	if (st.st_size > 0 && (data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED) {
+		close(fd);
+		return false;
+	}
+	close(fd);
+	if (data != NULL)
+		madvise(data, st.st_size, MADV_SEQUENTIAL);
+	bool ok = catalog_build(cat, data, st.st_size);
+	if (data != NULL)
+		munmap(data, st.st_size);
+	return ok;
+}
+
+/**
+Compile a catalog into a file that catalog_map uses in place, replacing any previous
+	version at once. The file holds offsets rather than pointers, so it may be mapped
+	anywhere, and each distinct name is stored once
+@param cat
+	A pointer to the catalog to be compiled
+@param path
+	The path of the compiled catalog
+@return
+	Whether the compiled catalog was written
+*/
+bool catalog_save(const Catalog *cat, const char *path) {
+	CatalogEntry *entries = aligned_alloc(sizeof(CatalogEntry), (cat->count + 1) * sizeof(CatalogEntry));
+	if (entries == NULL) {
+		ERROR("Out of memory");
+	}
+	memcpy(entries, cat->entries, cat->count * sizeof(CatalogEntry));
+	size_t names_len;
+	char *names = s_intern_names(cat, entries, &names_len);
+	CatalogImage h = {.magic = CATALOG_MAGIC, .version = CATALOG_VERSION, .seed = cat->seed,
+			.count = cat->count, .slots = cat->slots, .buckets = cat->buckets};
+	h.pilots = s_align(sizeof(h));
+	h.remap = s_align(h.pilots + cat->buckets * sizeof(uint16));
+	h.entries = s_align(h.remap + (cat->slots - cat->count) * sizeof(uint32));
+	h.names = s_align(h.entries + cat->count * sizeof(CatalogEntry));
+	h.names_len = names_len;
+	h.size = h.names + names_len;
+
+	char tmp[strlen(path) + 5];
+	snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+	FILE *file = fopen(tmp, "wb");
+	bool ok = file != NULL;
+	uint64 offset = 0;
+	if (ok) {
+		ok = s_write_section(file, &h, sizeof(h), &offset)
+				&& s_write_section(file, cat->pilots, cat->buckets * sizeof(uint16), &offset)
+				&& s_write_section(file, cat->remap, (cat->slots - cat->count) * sizeof(uint32), &offset)
+				&& s_write_section(file, entries, cat->count * sizeof(CatalogEntry), &offset)
+				&& fwrite(names, 1, names_len, file) == names_len;
+		ok = fclose(file) == 0 && ok;
+		if (ok)
+			ok = rename(tmp, path) == 0;
+		else
+			remove(tmp);
+	}
+	free(entries);
+	free(names);
+	return ok;
+}
+
+/**
+Map a compiled catalog read-only, using its arrays in place. Nothing is copied or
+	rebuilt, and every process mapping the file shares its pages
+@param cat
+	A pointer to the catalog to be mapped
+@param path
+	The path of the compiled catalog
+@return
+	False if the file could not be mapped, or is not a compiled catalog of this version
+*/
+bool catalog_map(Catalog *cat, const char *path) {
+	struct stat st;
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return false;
+	if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(CatalogImage)) {
+		close(fd);
+		return false;
+	}
+	char *image = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (image == MAP_FAILED)
+		return false;
+	const CatalogImage *h = (const CatalogImage*) image;
+	uint64 size = st.st_size;
+	bool ok = h->magic == CATALOG_MAGIC && h->version == CATALOG_VERSION && h->size == size
+			&& h->count <= h->slots && h->buckets > 0 && h->names_len > 0
+			&& s_fits(h->pilots, h->buckets, sizeof(uint16), size)
+			&& s_fits(h->remap, h->slots - h->count, sizeof(uint32), size)
+			&& s_fits(h->entries, h->count, sizeof(CatalogEntry), size)
+			&& s_fits(h->names, h->names_len, 1, size)
+			&& image[h->names + h->names_len - 1] == '\0';
+	// Remapped slots are checked, as they are few; entries are trusted, save their names
+	const uint32 *remap = (const uint32*) (image + h->remap);
+	for (uint64 i = 0; ok && h->count > 0 && i < h->slots - h->count; i++)
+		ok = remap[i] < h->count;
+	if (!ok) {
+		munmap(image, size);
+		return false;
+	}
+	cat->seed = h->seed;
+	cat->count = h->count;
+	cat->slots = h->slots;
+	cat->buckets = h->buckets;
+	cat->pilots = (uint16*) (image + h->pilots);
+	cat->remap = (uint32*) (image + h->remap);
+	cat->entries = (CatalogEntry*) (image + h->entries);
+	cat->names = image + h->names;
+	cat->names_len = h->names_len;
+	cat->image = image;
+	cat->image_len = size;
+	return true;
+}
+
+/**
+Find a product by its SKU
+@param cat
+	A pointer to the catalog
+@param sku
+	The SKU's chars, without the prefix used to enter it
+@param len
+	The number of chars
+@return
+	A pointer to the product's entry, or NULL if the catalog has no such SKU
+*/
+const CatalogEntry *catalog_find(const Catalog *cat, const char *sku, size_t len) {
+	if (len == 0 || len > CATALOG_SKU_MAX || cat->count == 0)
+		return NULL;
+	uint64 hash = s_hash(sku, len, cat->seed);
+	uint16 pilot = cat->pilots[s_bucket(hash, cat->buckets)];
+	const CatalogEntry *e = &cat->entries[s_entry(cat, s_mix(hash), pilot)];
+	return e->len == len && memcmp(e->sku, sku, len) == 0 ? e : NULL;
+}
+
+/**
+Scan an input naming a product, formatted as #SKU[xN], for the amount it represents
+@param cat
+	A pointer to the catalog
+@param s
+	The input's chars
+@param len
+	The number of chars
+@param multiplier
+	A pointer to where the multiplier applied is stored, or 0 if the input is invalid
+	or names no product in the catalog
+@param product
+	A pointer to where the product's entry is stored, if not NULL
+@return
+	The product's price times its multiplier, or 0 if the input is invalid
+*/
+Currency catalog_scan(const Catalog *cat, const char *s, size_t len, unsigned *multiplier,
+		const CatalogEntry **product) {
+	const char *end = s + len;
+	size_t head;
+	while (s < end && isspace((unsigned char) *s))
+		s++;
+	*multiplier = 0;
+	if (s == end || *s != CATALOG_SKU_PREFIX)
+		return 0;
+	s++;
+	unsigned mult = s_split_multiplier(s, end - s, &head);
+	const CatalogEntry *e = catalog_find(cat, s, head);
+	if (product != NULL)
+		*product = e;
+	if (e == NULL || mult == 0)
+		return 0;
+	*multiplier = mult;
+	return e->price * mult;
+}
+
+/**
+Find the name of a product
+@param cat
+	A pointer to the catalog
+@param product
+	A pointer to the product's entry
+@return
+	The product's name, which is empty if it has none
+*/
+const char *catalog_name(const Catalog *cat, const CatalogEntry *product) {
+	return product->name < cat->names_len ? cat->names + product->name : "";
+}
+
+/**
+Free the memory held by a catalog, or unmap it if it was compiled
+@param cat
+	A pointer to the catalog
+*/
+void catalog_free(Catalog *cat) {
+	if (cat->image != NULL) {
+		munmap(cat->image, cat->image_len);
+		return;
+	}
+	free(cat->pilots);
+	free(cat->remap);
+	free(cat->entries);
+	free(cat->names);
+}
@@ -0,0 +1,393 @@
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "daemon.h"
+#include "io.h"
+#include "wire.h"
+#include "utils.h"
+
+
+// Longest reply sent for a single line: "=> " + formatted total + "\n"
+#define MAX_REPLY_SIZE (MAX_BUFFER_SIZE + 4)
+// Size of the reply sent for each binary frame
+#define WIRE_REPLY_SIZE (sizeof(WireHeader) + sizeof(WireEntry))
+
+_Static_assert(sizeof(WireFrame) <= DAEMON_IN_SIZE, "largest frame must fit a session's buffer");
+
+
+/******
+ * Static Variables
+ ******/
+
+static volatile sig_atomic_t stopping = 0;
+
+
+/******
+ * Static Functions (marked with s_ prefix)
+ ******/
+
+static void s_stop(int signum) {
+	(void) signum;
+	stopping = 1;
+}
+
+// ***** Registers
+
+// Find the slot in which a register ID is, or would be, stored
+static RegisterTotal *s_register_slot(RegisterTotal *table, size_t capacity, uint32 id) {
+	size_t i = (id * 2654435761u) & (capacity - 1);
+	while (table[i].used && table[i].id != id)
+		i = (i + 1) & (capacity - 1);
+	return &table[i];
+}
+
+// Find the running total of a register, adding it with a total of 0 if it is new
+static Currency *s_register_total(Daemon *d, uint32 id) {
+	// Keep the table at most half full, so probe sequences stay short
+	if (2 * (d->register_count + 1) > d->register_capacity) {
+		size_t capacity = d->register_capacity ? 2 * d->register_capacity : DAEMON_MIN_REGISTERS;
+		RegisterTotal *table = calloc(capacity, sizeof(RegisterTotal));
+		if (table == NULL) {
+			ERROR("Out of memory");
+		}
+		for (size_t i = 0; i < d->register_capacity; i++) {
+			if (d->registers[i].used)
+				*s_register_slot(table, capacity, d->registers[i].id) = d->registers[i];
+		}
+		free(d->registers);
+		d->registers = table;
+		d->register_capacity = capacity;
+	}
+	RegisterTotal *slot = s_register_slot(d->registers, d->register_capacity, id);
+	if (!slot->used) {
+		slot->used = true;
+		slot->id = id;
+		slot->total = 0;
+		d->register_count++;
+	}
+	return &slot->total;
+}
+
+// ***** Sessions
+
+// Append the session's running total to its output buffer, as the REPL prints it
+static void s_session_reply(Session *s) {
+	sprint_currency(s->out + s->out_len, DAEMON_OUT_SIZE - s->out_len, "=> %s\n", s->total);
+	s->out_len += strlen(s->out + s->out_len);
+}
+
+// Apply every complete line in the input buffer to the total, while replies still fit
+static void s_session_process_text(Session *s) {
+	char *line = s->in, *end = s->in + s->in_len, *nl;
+	while (DAEMON_OUT_SIZE - s->out_len >= MAX_REPLY_SIZE
+			&& (nl = memchr(line, '\n', end - line)) != NULL) {
+		size_t len = nl - line;
+		if (len > 0 && line[len-1] == '\r')
+			len--;
+		line[len] = '\0';
+		// Lines too long for the scanner are invalid, and add nothing
+		if (!s->discarding && len < MAX_BUFFER_SIZE)
+			s->total += sscan_currency(line);
+		s->discarding = false;
+		s_session_reply(s);
+		line = nl + 1;
+	}
+	s->in_len = end - line;
+	memmove(s->in, line, s->in_len);
+	// A full buffer with no newline holds an overlong line; skip to its end
+	if (s->in_len == DAEMON_IN_SIZE) {
+		s->discarding = true;
+		s->in_len = 0;
+	}
+}
+
+// Apply every complete frame in the input buffer to its register, while replies still fit;
+// 	false if the session broke protocol
+static bool s_session_process_binary(Daemon *d, Session *s) {
+	char *frame = s->in, *end = s->in + s->in_len;
+	WireHeader header;
+	WireEntry entry;
+	while ((size_t) (end - frame) >= sizeof(WireHeader)
+			&& DAEMON_OUT_SIZE - s->out_len >= WIRE_REPLY_SIZE) {
+		memcpy(&header, frame, sizeof(WireHeader));
+		if (!wire_header_valid(&header))
+			return false;
+		if ((size_t) (end - frame) < wire_frame_size(&header))
+			break;
+		Currency *total = s_register_total(d, header.session);
+		char *p = frame + sizeof(WireHeader);
+		for (uint16 i = 0; i < header.count; i++, p += sizeof(WireEntry)) {
+			memcpy(&entry, p, sizeof(WireEntry));
+			if (entry.kind == WIRE_CURRENCY)
+				*total += entry.value * entry.multiplier;
+			else if (entry.kind == WIRE_PERCENT)
+				*total += *total * entry.value / 100;
+			else
+				return false;
+		}
+		// Reply with the register's new total
+		header.count = 1;
+		memset(&entry, 0, sizeof(WireEntry));
+		entry.value = *total;
+		entry.multiplier = 1;
+		entry.kind = WIRE_CURRENCY;
+		memcpy(s->out + s->out_len, &header, sizeof(WireHeader));
+		memcpy(s->out + s->out_len + sizeof(WireHeader), &entry, sizeof(WireEntry));
+		s->out_len += WIRE_REPLY_SIZE;
+		frame = p;
+	}
+	s->in_len = end - frame;
+	memmove(s->in, frame, s->in_len);
+	return true;
+}
+
+// Apply all complete input, in whichever protocol the session speaks; false if it broke protocol
+static bool s_session_process(Daemon *d, Session *s) {
+	if (s->mode == SESSION_NEW && s->in_len > 0)
+		s->mode = (uint8) s->in[0] == WIRE_MAGIC ? SESSION_BINARY : SESSION_TEXT;
+	if (s->mode == SESSION_BINARY)
+		return s_session_process_binary(d, s);
+	s_session_process_text(s);
+	return true;
+}
+
+// Write as much pending output as the socket accepts; false if the connection failed
+static bool s_session_flush(Session *s) {
+	while (s->out_sent < s->out_len) {
+		ssize_t n = write(s->fd, s->out + s->out_sent, s->out_len - s->out_sent);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return errno == EAGAIN || errno == EWOULDBLOCK;
+		}
+		s->out_sent += n;
+	}
+	s->out_len = s->out_sent = 0;
+	return true;
+}
+
+// Switch the events a session waits on between reading input and draining output, if
+// 	it is not waiting on them already
+static void s_session_watch(int epfd, Session *s, bool writing) {
+	if (s->writing == writing)
+		return;
+	struct epoll_event ev = {.events = writing ? EPOLLOUT : EPOLLIN, .data.ptr = s};
+	epoll_ctl(epfd, EPOLL_CTL_MOD, s->fd, &ev);
+	s->writing = writing;
+}
+
+// Serve a ready session until it would block; false once it should be closed
+static bool s_session_service(Daemon *d, Session *s) {
+	for (;;) {
+		if (!s_session_process(d, s) || !s_session_flush(s))
+			return false;
+		// Stop reading while replies are backed up, so a slow client cannot grow its buffer
+		if (s->out_len > 0) {
+			s_session_watch(d->epfd, s, true);
+			return true;
+		}
+		if (s->in_len == DAEMON_IN_SIZE)
+			continue;
+		ssize_t n = read(s->fd, s->in + s->in_len, DAEMON_IN_SIZE - s->in_len);
+		if (n > 0) {
+			s->in_len += n;
+		}
+		else if (n == 0) {
+			return false;
+		}
+		else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+			s_session_watch(d->epfd, s, false);
+			return true;
+		}
+		else if (errno != EINTR) {
+			return false;
+		}
+	}
+}
+
+static void s_session_close(Daemon *d, Session *s) {
+	if (s->prev != NULL)
+		s->prev->next = s->next;
+	else
+		d->sessions = s->next;
+	if (s->next != NULL)
+		s->next->prev = s->prev;
+	epoll_ctl(d->epfd, EPOLL_CTL_DEL, s->fd, NULL);
+	close(s->fd);
+	free(s);
+}
+
+// ***** Listening
+
+// Accept every pending connection as a new session
+static void s_accept_all(Daemon *d) {
+	int fd;
+	while ((fd = accept4(d->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+		if (!daemon_add(d, fd))
+			close(fd);
+	}
+}
+
+// Create a non-blocking socket listening at path, replacing any stale socket file
+static int s_listen(const char *path) {
+	struct sockaddr_un addr = {.sun_family = AF_UNIX};
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		ERROR("Socket path too long");
+	}
+	strcpy(addr.sun_path, path);
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		ERROR("Unable to create socket");
+	}
+	unlink(path);
+	if (bind(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0 || listen(fd, DAEMON_BACKLOG) < 0) {
+		ERROR("Unable to listen on socket");
+	}
+	return fd;
+}
+
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Prepare a daemon to serve register sessions
+@param d
+	A pointer to the daemon to be initialized
+@param path
+	The filesystem path at which a listening socket is created, or NULL if sessions
+	are only added with daemon_add
+*/
+void daemon_open(Daemon *d, const char *path) {
+	d->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (d->epfd < 0) {
+		ERROR("Unable to create epoll instance");
+	}
+	d->listen_fd = -1;
+	d->path = path;
+	d->sessions = NULL;
+	d->registers = NULL;
+	d->register_count = d->register_capacity = 0;
+	if (path != NULL) {
+		d->listen_fd = s_listen(path);
+		struct epoll_event ev = {.events = EPOLLIN, .data.ptr = NULL};
+		epoll_ctl(d->epfd, EPOLL_CTL_ADD, d->listen_fd, &ev);
+	}
+}
+
+/**
+Serve a connected socket as a new session. The daemon sets it non-blocking, and
+	closes it once the session ends
+@param d
+	A pointer to the daemon
+@param fd
+	A file descriptor connected to the session's client
+@return
+	Whether the session was added; if not, fd is left open
+*/
+bool daemon_add(Daemon *d, int fd) {
+	int flags = fcntl(fd, F_GETFL);
+	if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+		return false;
+	Session *s = malloc(sizeof(Session));
+	if (s == NULL) {
+		NONF_ERROR("Out of memory; connection refused");
+		return false;
+	}
+	s->fd = fd;
+	s->mode = SESSION_NEW;
+	s->total = 0;
+	s->discarding = s->writing = false;
+	s->in_len = s->out_len = s->out_sent = 0;
+	struct epoll_event ev = {.events = EPOLLIN, .data.ptr = s};
+	if (epoll_ctl(d->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+		free(s);
+		return false;
+	}
+	s->prev = NULL;
+	s->next = d->sessions;
+	if (d->sessions != NULL)
+		d->sessions->prev = s;
+	d->sessions = s;
+	return true;
+}
+
+/**
+Wait for sessions to become ready, then serve each until it would block, accepting any
+	new connections
+@param d
+	A pointer to the daemon
+@param timeout
+	The longest time to wait, in milliseconds, or -1 to wait indefinitely
+@return
+	The number of sessions and listening sockets served, or -1 if waiting failed
+*/
+int daemon_poll(Daemon *d, int timeout) {
+	struct epoll_event events[DAEMON_MAX_EVENTS];
+	int n = epoll_wait(d->epfd, events, DAEMON_MAX_EVENTS, timeout);
+	if (n < 0) {
+		if (errno == EINTR)
+			return 0;
+		NONF_ERROR("epoll_wait failed");
+		return -1;
+	}
+	for (int i = 0; i < n; i++) {
+		Session *s = events[i].data.ptr;
+		if (s == NULL)
+			s_accept_all(d);
+		else if (!s_session_service(d, s))
+			s_session_close(d, s);
+	}
+	return n;
+}
+
+/**
+Close every open session and the listening socket, removing its file, and forget the
+	register totals
+@param d
+	A pointer to the daemon
+*/
+void daemon_close(Daemon *d) {
+	while (d->sessions != NULL)
+		s_session_close(d, d->sessions);
+	free(d->registers);
+	close(d->epfd);
+	if (d->listen_fd >= 0) {
+		close(d->listen_fd);
+		unlink(d->path);
+	}
+}
+
+/**
+Serve register sessions over a UNIX domain socket until interrupted. Each line a
+	text session sends is scanned as currency and added to that session's own running
+	total, which is sent back as "=> $N.NN". Binary sessions send frames of pre-scanned
+	entries instead, as described in wire.h
+@param path
+	The filesystem path at which the socket is created
+@return
+	The exit status of the daemon
+*/
+int daemon_run(const char *path) {
+	Daemon d;
+	struct sigaction sa = {.sa_handler = s_stop};
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	signal(SIGPIPE, SIG_IGN);
+
+	daemon_open(&d, path);
+	while (!stopping && daemon_poll(&d, -1) >= 0)
+		;
+	daemon_close(&d);
+	return 0;
+}
@@ -0,0 +1,90 @@
+#include <stdlib.h>
+
+#include "fenwick.h"
+#include "utils.h"
+
+
+#define LOWBIT(i) ((i) & -(i))
+
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Prepare an empty Fenwick tree
+@param fenwick
+	A pointer to the tree to be initialized
+*/
+void fenwick_init(Fenwick *fenwick) {
+	fenwick->tree = NULL;
+	fenwick->count = 0;
+	fenwick->capacity = 0;
+}
+
+/**
+Append a value to the end of a Fenwick tree in O(log n), growing it geometrically as needed
+@param fenwick
+	A pointer to the tree receiving the value
+@param value
+	The value to be appended
+*/
+void fenwick_append(Fenwick *fenwick, Currency value) {
+	size_t i = fenwick->count + 1, j;
+	if (i >= fenwick->capacity) {
+		size_t capacity = fenwick->capacity ? 2 * fenwick->capacity : FENWICK_MIN_CAPACITY;
+		Currency *tree = realloc(fenwick->tree, capacity * sizeof(Currency));
+		if (tree == NULL) {
+			ERROR("Out of memory");
+		}
+		fenwick->tree = tree;
+		fenwick->capacity = capacity;
+	}
+	// The new node covers the value itself plus the nodes of its lowbit(i)-1 predecessors
+	fenwick->tree[i] = value;
+	for (j = i - 1; j > i - LOWBIT(i); j -= LOWBIT(j))
+		fenwick->tree[i] += fenwick->tree[j];
+	fenwick->count = i;
+}
+
+/**
+Add to the value at a given index in O(log n)
+@param fenwick
+	A pointer to the tree to be updated
+@param index
+	The 0-based index of the value
+@param delta
+	The amount to add; pass the negation of an amount to subtract it
+*/
+void fenwick_add(Fenwick *fenwick, size_t index, Currency delta) {
+	for (size_t i = index + 1; i <= fenwick->count; i += LOWBIT(i))
+		fenwick->tree[i] += delta;
+}
+
+/**
+Sum the first n values of a Fenwick tree in O(log n)
+@param fenwick
+	A pointer to the tree to be summed
+@param n
+	The number of values to include; clamped to the number of values in the tree
+@return
+	The sum of the first n values
+*/
+Currency fenwick_prefix(const Fenwick *fenwick, size_t n) {
+	Currency sum = 0;
+	if (n > fenwick->count)
+		n = fenwick->count;
+	for (size_t i = n; i > 0; i -= LOWBIT(i))
+		sum += fenwick->tree[i];
+	return sum;
+}
+
+/**
+Free the memory held by a Fenwick tree, leaving it empty
+@param fenwick
+	A pointer to the tree to be freed
+*/
+void fenwick_free(Fenwick *fenwick) {
+	free(fenwick->tree);
+	fenwick_init(fenwick);
+}
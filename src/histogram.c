@@ -0,0 +1,178 @@
+#include <string.h>
+
+#include "histogram.h"
+#include "io.h"
+#include "utils.h"
+
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define HISTOGRAM_AVX512
+#endif
+
+
+/******
+ * Static Functions (marked with s_ prefix)
+ ******/
+
+// Find the bucket of an amount without branching: the position of its leading bit, less
+// 	SUB_BITS, is how far it is shifted so that its leading SUB_BITS+1 bits remain
+static inline uint16 s_index(Currency amount) {
+	unsigned e = 63 - __builtin_clzl(amount | 1);
+	unsigned shift = e > HISTOGRAM_SUB_BITS ? e - HISTOGRAM_SUB_BITS : 0;
+	return (shift << HISTOGRAM_SUB_BITS) + (amount >> shift);
+}
+
+// Classify a batch of amounts into bucket indices
+static void s_classify_scalar(const Currency *amounts, size_t n, uint16 *out) {
+	for (size_t i = 0; i < n; i++)
+		out[i] = s_index(amounts[i]);
+}
+
+#ifdef HISTOGRAM_AVX512
+// Classify eight amounts at a time, with AVX-512's vector count of leading zeros
+__attribute__((target("avx512f,avx512cd")))
+static void s_classify_avx512(const Currency *amounts, size_t n, uint16 *out) {
+	const __m512i one = _mm512_set1_epi64(1), top = _mm512_set1_epi64(63 - HISTOGRAM_SUB_BITS);
+	const __m512i zero = _mm512_setzero_si512();
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m512i v = _mm512_loadu_si512(amounts + i);
+		__m512i lz = _mm512_lzcnt_epi64(_mm512_or_si512(v, one));
+		__m512i shift = _mm512_max_epi64(_mm512_sub_epi64(top, lz), zero);
+		__m512i index = _mm512_add_epi64(_mm512_slli_epi64(shift, HISTOGRAM_SUB_BITS),
+				_mm512_srlv_epi64(v, shift));
+		_mm_storeu_si128((__m128i*) (out + i), _mm512_cvtepi64_epi16(index));
+	}
+	s_classify_scalar(amounts + i, n - i, out + i);
+}
+#endif
+
+// Use the widest classifier the processor supports; the check is a load of flags
+// 	recorded at startup, so it is made for every batch
+static void s_classify(const Currency *amounts, size_t n, uint16 *out) {
+#ifdef HISTOGRAM_AVX512
+	if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd")) {
+		s_classify_avx512(amounts, n, out);
+		return;
+	}
+#endif
+	s_classify_scalar(amounts, n, out);
+}
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Prepare an empty histogram
+@param hist
+	A pointer to the histogram to be initialized
+*/
+void histogram_init(Histogram *hist) {
+	memset(hist, 0, sizeof(Histogram));
+}
+
+/**
+Find the bucket in which an amount is counted
+@param amount
+	The amount to be classified
+@return
+	The index of the amount's bucket
+*/
+size_t histogram_index(Currency amount) {
+	return s_index(amount);
+}
+
+/**
+Count an amount
+@param hist
+	A pointer to the histogram
+@param amount
+	The amount to be counted
+*/
+void histogram_add(Histogram *hist, Currency amount) {
+	hist->count++;
+	hist->buckets[s_index(amount)]++;
+}
+
+/**
+Count a batch of amounts, classifying all of them before any is counted so the
+	classification can be vectorized
+@param hist
+	A pointer to the histogram
+@param amounts
+	The amounts to be counted
+@param n
+	The number of amounts
+*/
+void histogram_add_batch(Histogram *hist, const Currency *amounts, size_t n) {
+	uint16 indices[HISTOGRAM_BATCH];
+	hist->count += n;
+	while (n > 0) {
+		size_t m = n < HISTOGRAM_BATCH ? n : HISTOGRAM_BATCH;
+		s_classify(amounts, m, indices);
+		for (size_t i = 0; i < m; i++)
+			hist->buckets[indices[i]]++;
+		amounts += m;
+		n -= m;
+	}
+}
+
+/**
+Add the counts of one histogram to another, as when combining per-thread histograms
+@param into
+	A pointer to the histogram receiving the counts
+@param from
+	A pointer to the histogram to be merged; it is left unchanged
+*/
+void histogram_merge(Histogram *into, const Histogram *from) {
+	into->count += from->count;
+	for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+		into->buckets[i] += from->buckets[i];
+}
+
+/**
+Find the least amount counted by a bucket
+@param i
+	The index of the bucket
+@return
+	The bucket's lower bound
+*/
+Currency histogram_floor(size_t i) {
+	if (i < (2 << HISTOGRAM_SUB_BITS))
+		return i;
+	unsigned shift = (i >> HISTOGRAM_SUB_BITS) - 1;
+	return (Currency) (i - ((size_t) shift << HISTOGRAM_SUB_BITS)) << shift;
+}
+
+/**
+Find the greatest amount counted by a bucket
+@param i
+	The index of the bucket
+@return
+	The bucket's upper bound, inclusive
+*/
+Currency histogram_ceiling(size_t i) {
+	return i + 1 < HISTOGRAM_BUCKETS ? histogram_floor(i + 1) - 1 : (Currency) -1;
+}
+
+/**
+Print a line for each bucket holding any amounts, with its bounds and count
+@param hist
+	A pointer to the histogram
+@param file
+	A pointer to the file stream to which the histogram is printed
+@param prefix
+	Printed at the start of each line
+*/
+void histogram_dump(const Histogram *hist, FILE *file, const char *prefix) {
+	for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		if (hist->buckets[i] == 0)
+			continue;
+		fputs(prefix, file);
+		fprint_currency(file, "%s", histogram_floor(i));
+		fprint_currency(file, " to %s: ", histogram_ceiling(i));
+		fprintf(file, "%lu\n", hist->buckets[i]);
+	}
+}
@@ -0,0 +1,269 @@
+#include <errno.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "ingest.h"
+#include "utils.h"
+
+
+/******
+ * Static Functions (marked with s_ prefix)
+ ******/
+
+// ***** io_uring
+// There is no liburing dependency; the rings are set up and driven through raw system calls
+
+static void s_uring_unmap(Uring *ring) {
+	if (ring->sqes != NULL && ring->sqes != MAP_FAILED)
+		munmap(ring->sqes, ring->sqes_len);
+	if (ring->cq_ptr != NULL && ring->cq_ptr != MAP_FAILED && ring->cq_ptr != ring->sq_ptr)
+		munmap(ring->cq_ptr, ring->cq_len);
+	if (ring->sq_ptr != NULL && ring->sq_ptr != MAP_FAILED)
+		munmap(ring->sq_ptr, ring->sq_len);
+	close(ring->fd);
+}
+
+// Create an io_uring instance and map its queues; false if the kernel refuses
+static bool s_uring_init(Uring *ring, unsigned entries) {
+	struct io_uring_params p;
+	memset(&p, 0, sizeof(p));
+	memset(ring, 0, sizeof(Uring));
+	ring->fd = syscall(__NR_io_uring_setup, entries, &p);
+	if (ring->fd < 0)
+		return false;
+
+	ring->sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	ring->cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+	if (single)
+		ring->sq_len = ring->cq_len = ring->sq_len > ring->cq_len ? ring->sq_len : ring->cq_len;
+	ring->sq_ptr = mmap(NULL, ring->sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			ring->fd, IORING_OFF_SQ_RING);
+	ring->cq_ptr = single ? ring->sq_ptr : mmap(NULL, ring->cq_len, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+	ring->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = mmap(NULL, ring->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			ring->fd, IORING_OFF_SQES);
+	if (ring->sq_ptr == MAP_FAILED || ring->cq_ptr == MAP_FAILED || ring->sqes == MAP_FAILED) {
+		s_uring_unmap(ring);
+		return false;
+	}
+	char *sq = ring->sq_ptr, *cq = ring->cq_ptr;
+	ring->sq_tail = (unsigned*) (sq + p.sq_off.tail);
+	ring->sq_mask = (unsigned*) (sq + p.sq_off.ring_mask);
+	ring->sq_array = (unsigned*) (sq + p.sq_off.array);
+	ring->cq_head = (unsigned*) (cq + p.cq_off.head);
+	ring->cq_tail = (unsigned*) (cq + p.cq_off.tail);
+	ring->cq_mask = (unsigned*) (cq + p.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe*) (cq + p.cq_off.cqes);
+	return true;
+}
+
+// Queue a read and tell the kernel about it
+static bool s_uring_read(Ingest *in, IngestRead *r, size_t slot) {
+	Uring *ring = &in->ring;
+	unsigned tail = *ring->sq_tail, i = tail & *ring->sq_mask;
+	struct io_uring_sqe *sqe = &ring->sqes[i];
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = in->fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+	sqe->fd = in->fd;
+	sqe->off = r->offset;
+	sqe->addr = (unsigned long) r->addr;
+	sqe->len = r->len;
+	sqe->buf_index = in->fixed ? r->buffer : 0;
+	sqe->user_data = slot;
+	ring->sq_array[i] = i;
+	atomic_store_explicit((_Atomic unsigned*) ring->sq_tail, tail + 1, memory_order_release);
+	int n;
+	while ((n = syscall(__NR_io_uring_enter, ring->fd, 1, 0, 0, NULL, 0)) < 0 && errno == EINTR)
+		;
+	return n == 1;
+}
+
+// Wait for one completion, and record its result against the read it belongs to; false if
+// 	the ring itself fails, rather than one of its reads
+static bool s_uring_reap(Ingest *in) {
+	Uring *ring = &in->ring;
+	unsigned head = *ring->cq_head;
+	while (head == atomic_load_explicit((_Atomic unsigned*) ring->cq_tail, memory_order_acquire)) {
+		if (syscall(__NR_io_uring_enter, ring->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR)
+			return false;
+	}
+	struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+	IngestRead *r = &in->reads[cqe->user_data];
+	r->result = cqe->res;
+	r->done = true;
+	atomic_store_explicit((_Atomic unsigned*) ring->cq_head, head + 1, memory_order_release);
+	return true;
+}
+
+// Give up on a failed ring: closing it cancels whatever reads it still holds, which are
+// 	marked failed so pread performs them, as it does every read from then on
+static void s_uring_abandon(Ingest *in) {
+	s_uring_unmap(&in->ring);
+	in->mode = INGEST_PREAD;
+	in->fixed = false;
+	for (size_t i = 0; i < in->count; i++) {
+		IngestRead *r = &in->reads[(in->head + i) % INGEST_DEPTH];
+		if (!r->done) {
+			r->done = true;
+			r->result = -1;
+		}
+	}
+}
+
+// ***** pread
+
+// Fill a read synchronously, from wherever it stands, until it is full or the file ends
+static void s_pread_rest(Ingest *in, IngestRead *r) {
+	size_t got = r->result > 0 ? r->result : 0;
+	while (got < r->len) {
+		ssize_t n = in->stream ? read(in->fd, r->addr + got, r->len - got)
+				: pread(in->fd, r->addr + got, r->len - got, r->offset + got);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0) {
+			r->result = -1;
+			return;
+		}
+		if (n == 0)
+			break;
+		got += n;
+	}
+	r->result = got;
+}
+
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Prepare to read a file sequentially into a set of buffers. With io_uring the
+	buffers are registered with the kernel, so reads need not pin pages each time
+@param in
+	A pointer to the reader to be initialized
+@param fd
+	A file descriptor open for reading, positioned at the start of the data
+@param mode
+	Which backend to use; INGEST_AUTO falls back to pread if io_uring is unavailable
+@param buffers
+	The buffers reads will be placed in
+@param count
+	The number of buffers
+@param size
+	The size of each buffer
+@return
+	Whether the reader was initialized; false only if INGEST_URING was required but unavailable.
+	Files without offsets, such as pipes, are always read in order with read()
+*/
+bool ingest_init(Ingest *in, int fd, IngestMode mode, char **buffers, size_t count, size_t size) {
+	in->fd = fd;
+	in->fixed = false;
+	in->offset = lseek(fd, 0, SEEK_CUR);
+	in->stream = in->offset < 0;
+	in->head = in->count = 0;
+	in->mode = INGEST_PREAD;
+	if (in->stream) {
+		in->offset = 0;
+		return mode != INGEST_URING;
+	}
+	if (mode == INGEST_PREAD)
+		return true;
+	if (!s_uring_init(&in->ring, INGEST_DEPTH))
+		return mode == INGEST_AUTO;
+	in->mode = INGEST_URING;
+	// Registration counts against RLIMIT_MEMLOCK; plain reads still work without it
+	struct iovec iovs[count];
+	for (size_t i = 0; i < count; i++) {
+		iovs[i].iov_base = buffers[i];
+		iovs[i].iov_len = size;
+	}
+	in->fixed = syscall(__NR_io_uring_register, in->ring.fd, IORING_REGISTER_BUFFERS, iovs, count) == 0;
+	return true;
+}
+
+/**
+Submit a read of the next len bytes of the file
+@param in
+	A pointer to the reader
+@param buffer
+	The index of the buffer, as passed to ingest_init, that addr lies within
+@param addr
+	A pointer to where the bytes are placed
+@param len
+	The number of bytes to read
+@return
+	Whether the read was submitted; false if INGEST_DEPTH reads are already pending
+*/
+bool ingest_submit(Ingest *in, int buffer, char *addr, size_t len) {
+	if (in->count == INGEST_DEPTH)
+		return false;
+	size_t slot = (in->head + in->count) % INGEST_DEPTH;
+	IngestRead *r = &in->reads[slot];
+	r->buffer = buffer;
+	r->addr = addr;
+	r->len = len;
+	r->offset = in->offset;
+	r->done = false;
+	r->result = 0;
+	in->offset += len;
+	in->count++;
+	// pread performs the read once it is waited on
+	if (in->mode == INGEST_URING && !s_uring_read(in, r, slot)) {
+		r->done = true;
+		r->result = -1;
+	}
+	return true;
+}
+
+/**
+Wait for the oldest pending read to complete. Reads are returned in the order
+	they were submitted, however the kernel completes them
+@param in
+	A pointer to the reader
+@param result
+	A pointer to where the number of bytes read is stored; less than requested
+	only at the end of the file, or -1 on error
+@return
+	The buffer index of the completed read, or -1 if no read is pending
+*/
+int ingest_wait(Ingest *in, ssize_t *result) {
+	if (in->count == 0)
+		return -1;
+	IngestRead *r = &in->reads[in->head];
+	if (in->mode == INGEST_URING) {
+		while (!r->done) {
+			if (!s_uring_reap(in))
+				s_uring_abandon(in);
+		}
+	}
+	if (r->result < 0) {
+		// The kernel may reject the read itself; pread reports the real failure, if any
+		r->result = 0;
+	}
+	// Short reads are completed synchronously, so a short result always means end of file
+	if (r->result >= 0 && (size_t) r->result < r->len)
+		s_pread_rest(in, r);
+	in->head = (in->head + 1) % INGEST_DEPTH;
+	in->count--;
+	*result = r->result;
+	return r->buffer;
+}
+
+/**
+Release the resources held by a reader, waiting out any reads still in flight
+@param in
+	A pointer to the reader to be closed
+*/
+void ingest_close(Ingest *in) {
+	ssize_t result;
+	while (ingest_wait(in, &result) >= 0)
+		;
+	if (in->mode == INGEST_URING)
+		s_uring_unmap(&in->ring);
+}
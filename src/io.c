@@ -39,67 +39,79 @@ static int s_fscann(char *buf, size_t n, FILE *file) {
 // ***** Currency IO
 
 // *** Prototypes
-static Currency s_get_units(char**);
-static Currency s_get_cents(char**);
-static unsigned s_get_multiplier(char**);
+static Currency s_get_units(const char**, const char*);
+static Currency s_get_cents(const char**, const char*);
+static unsigned s_get_multiplier(const char**, const char*);
 
 // *** Definitions
-// Convert an amount of currency into its str representation, then save it to the IO buffer
-static char *s_currency_to_str(Currency amount) {
+// Convert an amount of currency into its str representation within buf, returning its len
+static int s_format_currency(char *buf, size_t len, Currency amount) {
 	uint64 unit_count = (uint64) (amount / 100);
 	uint8 cent_count = (uint8) (amount % 100);
 
 	// Place unit portion's str representation in buffer, record the len of the output
-	int unit_len = snprintf(io_buffer, MAX_BUFFER_SIZE, "%s%'d", CURRENCY_SYM, unit_count);
+	int unit_len = snprintf(buf, len, "%s%'lu", CURRENCY_SYM, unit_count);
 
 	// If the buffer isn't full
-	if (unit_len+1 < MAX_BUFFER_SIZE) {
+	if (unit_len+1 < (int) len) {
 		// Append the cent str representation to the buffer
-		snprintf(io_buffer+unit_len, MAX_BUFFER_SIZE-unit_len, ".%02d", cent_count);
+		return unit_len + snprintf(buf+unit_len, len-unit_len, ".%02u", cent_count);
 	}
-	
+	return unit_len;
+}
+
+// Convert an amount of currency into its str representation, then save it to the IO buffer
+static char *s_currency_to_str(Currency amount) {
+	s_format_currency(io_buffer, MAX_BUFFER_SIZE, amount);
 	// Return a reference to IO buffer
 	return io_buffer;
 }
 
-// Convert the str in the IO buffer into the amount of currency it represents, if possible
-static Currency s_str_to_currency() {
-	char *s = io_buffer, *sym_s = CURRENCY_SYM;
+// Convert the chars from s up to end into the amount of currency they represent, if possible;
+// 	The multiplier applied to it is stored in *multiplier, or 0 if the chars are invalid
+static Currency s_scan_item(const char *s, const char *end, unsigned *multiplier) {
+	const char *sym_s = CURRENCY_SYM;
 	Currency out = 0;
+	*multiplier = 0;
 	// Skip whitespace
-	while (isspace(*s)) 
+	while (s < end && isspace((unsigned char) *s))
 		s++;
 	// Skip currency string
-	while (*s == *sym_s) {
+	while (s < end && *sym_s != '\0' && *s == *sym_s) {
 		sym_s++;
 		s++;
 	}
-	if (!isdigit(*s))  // Inputs containing excess non-digits are invalid
+	if (s == end || !isdigit((unsigned char) *s))  // Inputs containing excess non-digits are invalid
 		return INV_CURR;
-	out += s_get_units(&s);
-	out += s_get_cents(&s);
-	out *= s_get_multiplier(&s);
-	if (*s != '\0')   // Inputs of excess length are invalid
+	out += s_get_units(&s, end);
+	out += s_get_cents(&s, end);
+	unsigned mult = s_get_multiplier(&s, end);
+	if (s != end)   // Inputs of excess length are invalid
 		return INV_CURR;
-	return out;
+	*multiplier = mult;
+	return out * mult;
 }
 
-static Currency s_get_units(char **pstr) {
+// Convert the str in the IO buffer into the amount of currency it represents, if possible
+static Currency s_str_to_currency(unsigned *multiplier) {
+	return s_scan_item(io_buffer, io_buffer + strlen(io_buffer), multiplier);
+}
+
+static Currency s_get_units(const char **pstr, const char *end) {
 	Currency out = 0;
-	int len;
-	if (sscanf(*pstr, "%lu%n", &out, &len) > 0) {
-		out *= 100;
-		*pstr += len;
+	while (*pstr < end && isdigit((unsigned char) **pstr)) {
+		out *= 10;
+		out += *(*pstr)++ - '0';
 	}
-	return out;
+	return out * 100;
 }
 
-static Currency s_get_cents(char **pstr) {
+static Currency s_get_cents(const char **pstr, const char *end) {
 	Currency out = 0;
 	unsigned base = 10;
-	if (**pstr == '.') {
+	if (*pstr < end && **pstr == '.') {
 		(*pstr)++;
-		while (isdigit(**pstr)) {
+		while (*pstr < end && isdigit((unsigned char) **pstr)) {
 			out += base * (*(*pstr)++ - '0');
 			base /= 10;
 		}
@@ -107,12 +119,12 @@ static Currency s_get_cents(char **pstr) {
 	return out;
 }
 
-static unsigned s_get_multiplier(char** pstr) {
-	if (tolower(**pstr) != 'x')
-		return 1;  // No multiplier given 
+static unsigned s_get_multiplier(const char **pstr, const char *end) {
+	if (*pstr == end || tolower((unsigned char) **pstr) != 'x')
+		return 1;  // No multiplier given
 	(*pstr)++;
 	unsigned out = 0;
-	while (isdigit(**pstr)) {
+	while (*pstr < end && isdigit((unsigned char) **pstr)) {
 		out *= 10;
 		out += *(*pstr)++ - '0';
 	}
@@ -180,6 +192,22 @@ char *sprint_currency(char *out, size_t len, char *format, Currency amount) {
 	return out;
 }
 
+/**
+Place the string representation of an amount of currency into a char buffer. Unlike
+	sprint_currency, the shared IO buffer is left untouched, so threads may call this at once
+@param out
+	A pointer to the buffer where the representation is stored
+@param len
+	The length of the output buffer; MAX_BUFFER_SIZE holds any amount
+@param amount
+	The amount of currency to be represented as a str
+@return
+	The number of chars in the representation, as returned by snprintf
+*/
+int sprint_currency_r(char *out, size_t len, Currency amount) {
+	return s_format_currency(out, len, amount);
+}
+
 /**
 Print the string representation of an amount of currency to a file stream
 @param file
@@ -219,9 +247,43 @@ Scan a string for the string representation of a currency value,
 	The currency value represented in the string
 */
 Currency sscan_currency(char *in) {
+	unsigned multiplier;
+	return sscan_line_item(in, &multiplier);
+}
+
+/**
+Scan a string for the string representation of a line item, being a currency
+	value with an optional multiplier, then return its extended value
+@param in
+	The string to be scanned
+@param multiplier
+	A pointer to where the item's multiplier is stored; 1 if none was given,
+	or 0 if the string is invalid
+@return
+	The currency value represented in the string, multiplier applied
+*/
+Currency sscan_line_item(char *in, unsigned *multiplier) {
 	// Copy the input str to the IO buffer
 	strncpy(io_buffer, in, MAX_BUFFER_SIZE);
-	return s_str_to_currency();
+	return s_str_to_currency(multiplier);
+}
+
+/**
+Scan a run of chars for the string representation of a line item, as in
+	sscan_line_item, without copying them to the IO buffer. The chars need not
+	be null-terminated, and the call is safe from any thread
+@param in
+	The chars to be scanned
+@param len
+	The number of chars to be scanned
+@param multiplier
+	A pointer to where the item's multiplier is stored; 1 if none was given,
+	or 0 if the chars are invalid
+@return
+	The currency value represented by the chars, multiplier applied
+*/
+Currency sscann_line_item(const char *in, size_t len, unsigned *multiplier) {
+	return s_scan_item(in, in + len, multiplier);
 }
 
 /**
@@ -233,8 +295,9 @@ Scan a file stream for the string representation of a currency value,
 	The currency value represented in the file stream
 */
 Currency fscan_currency(FILE *in) {
+	unsigned multiplier;
 	s_fscann(io_buffer, MAX_BUFFER_SIZE, in);
-	return s_str_to_currency();
+	return s_str_to_currency(&multiplier);
 }
 
 /**
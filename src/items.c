@@ -0,0 +1,173 @@
+#include <stdlib.h>
+
+#include "items.h"
+#include "fenwick.h"
+#include "rollup.h"
+#include "utils.h"
+
+
+/******
+ * Static Functions (marked with s_ prefix)
+ ******/
+
+// Resize one of the store's arrays, exiting if memory is exhausted
+static void *s_resize(void *array, size_t capacity, size_t size) {
+	void *out = realloc(array, capacity * size);
+	if (out == NULL) {
+		ERROR("Out of memory");
+	}
+	return out;
+}
+
+// Double the capacity of every array in the store
+static void s_grow(ItemStore *store) {
+	size_t capacity = store->capacity ? 2 * store->capacity : ITEMS_MIN_CAPACITY;
+	store->amounts = s_resize(store->amounts, capacity, sizeof(Currency));
+	store->multipliers = s_resize(store->multipliers, capacity, sizeof(uint32));
+	store->types = s_resize(store->types, capacity, sizeof(uint8));
+	store->times = s_resize(store->times, capacity, sizeof(uint64));
+	store->capacity = capacity;
+}
+
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Prepare an empty store of line items
+@param store
+	A pointer to the store to be initialized
+*/
+void items_init(ItemStore *store) {
+	store->amounts = NULL;
+	store->multipliers = NULL;
+	store->types = NULL;
+	store->times = NULL;
+	fenwick_init(&store->totals);
+	rollup_init(&store->rollups);
+	store->count = 0;
+	store->capacity = 0;
+}
+
+/**
+Append a line item to a store, stamped with the coarse clock. Storage grows
+	geometrically, so appends only allocate once the store doubles in size
+@param store
+	A pointer to the store receiving the item
+@param amount
+	The item's extended amount, multiplier applied
+@param multiplier
+	The multiplier that was applied to the item
+@param type
+	The kind of line item
+@return
+	The index of the new item
+*/
+size_t items_push(ItemStore *store, Currency amount, uint32 multiplier, ItemType type) {
+	if (store->count == store->capacity)
+		s_grow(store);
+	size_t i = store->count++;
+	store->amounts[i] = amount;
+	store->multipliers[i] = multiplier;
+	store->types[i] = type;
+	store->times[i] = rollup_now();
+	fenwick_append(&store->totals, type == ITEM_VOID ? 0 : amount);
+	if (type != ITEM_VOID)
+		rollup_add(&store->rollups, store->times[i], amount, 1);
+	return i;
+}
+
+/**
+Mark a line item as void, removing it from all subtotals in O(log n), and from the
+	sales of the periods in which it was entered
+@param store
+	A pointer to the store holding the item
+@param i
+	The index of the item
+@return
+	Whether the item was voided; false if it does not exist or is already void
+*/
+bool items_void(ItemStore *store, size_t i) {
+	if (i >= store->count || store->types[i] == ITEM_VOID)
+		return false;
+	store->types[i] = ITEM_VOID;
+	fenwick_add(&store->totals, i, -store->amounts[i]);
+	rollup_add(&store->rollups, store->times[i], -store->amounts[i], -1);
+	return true;
+}
+
+/**
+Correct the amount of a line item, updating all subtotals in O(log n)
+@param store
+	A pointer to the store holding the item
+@param i
+	The index of the item
+@param amount
+	The item's corrected extended amount, multiplier applied
+@param multiplier
+	The multiplier that was applied to the corrected amount
+@return
+	Whether the item was edited; false if it does not exist or is void
+*/
+bool items_edit(ItemStore *store, size_t i, Currency amount, uint32 multiplier) {
+	if (i >= store->count || store->types[i] == ITEM_VOID)
+		return false;
+	fenwick_add(&store->totals, i, amount - store->amounts[i]);
+	rollup_add(&store->rollups, store->times[i], amount - store->amounts[i], 0);
+	store->amounts[i] = amount;
+	store->multipliers[i] = multiplier;
+	return true;
+}
+
+/**
+Sum the amounts of the first n line items, skipping voided items, in O(log n)
+@param store
+	A pointer to the store to be summed
+@param n
+	The number of items to include; clamped to the number of items in the store
+@return
+	The subtotal of the first n items
+*/
+Currency items_subtotal(const ItemStore *store, size_t n) {
+	return fenwick_prefix(&store->totals, n);
+}
+
+/**
+Count the line items of a given type, and sum their amounts. The scan is
+	branch-free so that it can be vectorized
+@param store
+	A pointer to the store to be scanned
+@param type
+	The kind of line item to be counted
+@param sum
+	A pointer to where the sum of the matching items is stored; may be NULL
+@return
+	The number of matching items
+*/
+size_t items_tally(const ItemStore *store, ItemType type, Currency *sum) {
+	size_t count = 0;
+	Currency total = 0;
+	for (size_t i = 0; i < store->count; i++) {
+		Currency match = store->types[i] == type;
+		count += match;
+		total += store->amounts[i] & -match;
+	}
+	if (sum != NULL)
+		*sum = total;
+	return count;
+}
+
+/**
+Free the arrays held by a store, leaving it empty
+@param store
+	A pointer to the store to be freed
+*/
+void items_free(ItemStore *store) {
+	free(store->amounts);
+	free(store->multipliers);
+	free(store->types);
+	free(store->times);
+	fenwick_free(&store->totals);
+	items_init(store);
+}
@@ -0,0 +1,170 @@
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "journal.h"
+#include "io.h"
+#include "sum.h"
+#include "topk.h"
+#include "utils.h"
+
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Scan the lines of a journal held in memory. Each line is scanned as a line item,
+	exactly as the REPL scans input; invalid lines scan as 0. Lines of MAX_BUFFER_SIZE
+	chars or more are too long for the REPL to accept, and are invalid whatever they hold
+@param data
+	The journal's chars, beginning at the start of a line
+@param len
+	The number of chars available
+@param final
+	Whether data ends the journal, so that chars after its last newline form a line
+@param amounts
+	A pointer to where the amount of each line is stored, in order
+@param max
+	The greatest number of lines to scan
+@param consumed
+	A pointer to where the number of chars making up the scanned lines is stored
+@return
+	The number of lines scanned
+*/
+size_t journal_parse(const char *data, size_t len, bool final, Currency *amounts, size_t max,
+		size_t *consumed) {
+	const char *p = data, *end = data + len, *nl;
+	unsigned multiplier;
+	size_t n = 0;
+	while (n < max && p < end) {
+		nl = memchr(p, '\n', end - p);
+		if (nl == NULL && !final)
+			break;
+		const char *line_end = nl != NULL ? nl : end;
+		size_t line_len = line_end - p;
+		if (line_len > 0 && p[line_len-1] == '\r')
+			line_len--;
+		amounts[n++] = line_len < MAX_BUFFER_SIZE ? sscann_line_item(p, line_len, &multiplier) : 0;
+		p = nl != NULL ? nl + 1 : end;
+	}
+	*consumed = p - data;
+	return n;
+}
+
+/**
+Total a journal by mapping it into memory and scanning it in place, with no copies.
+	Pages are released once scanned, so resident memory stays bounded however large
+	the journal is
+@param fd
+	A file descriptor open for reading a regular file
+@param out
+	A pointer to where the journal's total and line count are stored
+@param top
+	A pointer to a tracker offered every entry with its line number; may be NULL
+@return
+	Whether the journal could be mapped
+*/
+bool journal_total_mapped(int fd, JournalTotal *out, TopK *top) {
+	Currency amounts[JOURNAL_MAP_BATCH];
+	struct stat st;
+	Sum sum;
+	sum_init(&sum);
+	out->total = 0;
+	out->lines = 0;
+	out->overflowed = false;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+		return false;
+	size_t len = st.st_size, offset = 0, released = 0, consumed, n;
+	if (len == 0)
+		return true;
+	char *data = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (data == MAP_FAILED)
+		return false;
+	// Hints only; huge pages apply where the filesystem supports them
+	madvise(data, len, MADV_SEQUENTIAL);
+	madvise(data, len, MADV_HUGEPAGE);
+	size_t page = sysconf(_SC_PAGESIZE);
+	while (offset < len) {
+		n = journal_parse(data + offset, len - offset, true, amounts, JOURNAL_MAP_BATCH, &consumed);
+		sum_amounts(&sum, amounts, n, SUM_AUTO);
+		if (top != NULL)
+			topk_offer_batch(top, amounts, n, out->lines + 1);
+		out->lines += n;
+		offset += consumed;
+		// Drop whole pages behind the scan; the file itself is untouched
+		size_t behind = offset / page * page;
+		if (behind - released >= JOURNAL_RELEASE_SIZE) {
+			madvise(data + released, behind - released, MADV_DONTNEED);
+			released = behind;
+		}
+	}
+	out->total = sum.low;
+	out->overflowed = !sum_fits(&sum);
+	munmap(data, len);
+	return true;
+}
+
+/**
+Append an entry to a journal as a line of its own, in a single write so that
+	concurrent appenders never interleave
+@param fd
+	A file descriptor open for appending to the journal
+@param line
+	The entry's chars, without a newline
+@param len
+	The number of chars in the entry
+@return
+	Whether the whole line was written
+*/
+bool journal_append(int fd, const char *line, size_t len) {
+	struct iovec iov[2] = {{(void*) line, len}, {"\n", 1}};
+	return writev(fd, iov, 2) == (ssize_t) len + 1;
+}
+
+/**
+Fingerprint the chars of a journal preceding an offset, so that what was derived from
+	them, as a checkpoint or an index, can tell whether the journal was since rewritten
+	rather than appended to. Only the last JOURNAL_PRINT_SIZE chars are hashed, with the
+	offset, so fingerprinting costs the same however long the journal grows
+@param tail
+	The chars preceding the offset, of which at most the last JOURNAL_PRINT_SIZE are read
+@param len
+	The number of chars in tail
+@param offset
+	The offset, into the journal, at which tail ends
+@return
+	The fingerprint, a 64-bit FNV-1a hash
+*/
+uint64 journal_fingerprint(const char *tail, size_t len, uint64 offset) {
+	uint64 h = 0xcbf29ce484222325UL ^ offset;
+	if (len > JOURNAL_PRINT_SIZE) {
+		tail += len - JOURNAL_PRINT_SIZE;
+		len = JOURNAL_PRINT_SIZE;
+	}
+	for (size_t i = 0; i < len; i++)
+		h = (h ^ (uint8) tail[i]) * 0x100000001b3UL;
+	return h;
+}
+
+/**
+Fingerprint the chars of a journal preceding an offset, reading them from its file
+@param fd
+	A file descriptor open for reading the journal
+@param offset
+	The offset, which must not be past the end of the journal
+@param out
+	A pointer to where the fingerprint is stored
+@return
+	Whether the chars could be read
+*/
+bool journal_fingerprint_fd(int fd, uint64 offset, uint64 *out) {
+	char tail[JOURNAL_PRINT_SIZE];
+	size_t len = offset < JOURNAL_PRINT_SIZE ? offset : JOURNAL_PRINT_SIZE;
+	if (pread(fd, tail, len, offset - len) != (ssize_t) len)
+		return false;
+	*out = journal_fingerprint(tail, len, offset);
+	return true;
+}
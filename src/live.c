@@ -0,0 +1,183 @@
+#include <sched.h>
+#include <stdlib.h>
+
+#include "live.h"
+#include "catalog.h"
+#include "utils.h"
+
+
+/******
+ * Static Functions (marked with s_ prefix)
+ ******/
+
+// Map the compiled catalog at path, or else load it as text, into a catalog of its own
+static Catalog *s_open(const char *path) {
+	Catalog *cat = malloc(sizeof(Catalog));
+	if (cat == NULL) {
+		ERROR("Out of memory");
+	}
+	if (!catalog_map(cat, path) && !catalog_load(cat, path)) {
+		free(cat);
+		return NULL;
+	}
+	return cat;
+}
+
+static void s_destroy(Catalog *cat) {
+	catalog_free(cat);
+	free(cat);
+}
+
+// Check that no reader still reads in an epoch before the given one
+static bool s_passed(LiveCatalog *live, uint64 epoch) {
+	size_t n = atomic_load(&live->registered);
+	if (n > LIVE_MAX_READERS)
+		n = LIVE_MAX_READERS;
+	for (size_t i = 0; i < n; i++) {
+		uint64 announced = atomic_load(&live->readers[i].epoch);
+		if (announced != 0 && announced < epoch)
+			return false;
+	}
+	return true;
+}
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Open a catalog for reading while it is replaced
+@param live
+	A pointer to the live catalog to be initialized
+@param path
+	The path of the first catalog, compiled or as text
+@return
+	False if the catalog could not be loaded
+*/
+bool live_init(LiveCatalog *live, const char *path) {
+	Catalog *first = s_open(path);
+	if (first == NULL)
+		return false;
+	atomic_init(&live->current, first);
+	atomic_init(&live->epoch, 1);
+	atomic_init(&live->registered, 0);
+	for (size_t i = 0; i < LIVE_MAX_READERS; i++)
+		atomic_init(&live->readers[i].epoch, 0);
+	pthread_mutex_init(&live->lock, NULL);
+	live->retired = NULL;
+	return true;
+}
+
+/**
+Claim the announcement of a thread that will read the catalog
+@param live
+	A pointer to the live catalog
+@return
+	The thread's reader, or NULL if LIVE_MAX_READERS are already registered
+*/
+LiveReader *live_register(LiveCatalog *live) {
+	size_t i = atomic_fetch_add(&live->registered, 1);
+	return i < LIVE_MAX_READERS ? &live->readers[i] : NULL;
+}
+
+/**
+Begin reading the current catalog, which stays valid until live_exit even if it is
+	replaced meanwhile. The epoch is announced before the catalog is loaded, so a writer
+	that has since swapped it out sees the announcement before freeing it
+@param live
+	A pointer to the live catalog
+@param reader
+	The calling thread's reader, which must not already be reading
+@return
+	The current catalog
+*/
+const Catalog *live_enter(LiveCatalog *live, LiveReader *reader) {
+	atomic_store(&reader->epoch, atomic_load(&live->epoch));
+	return atomic_load(&live->current);
+}
+
+/**
+Finish reading the catalog returned by live_enter, after which it may be freed
+@param reader
+	The calling thread's reader
+*/
+void live_exit(LiveReader *reader) {
+	atomic_store_explicit(&reader->epoch, 0, memory_order_release);
+}
+
+/**
+Replace the current catalog, then free any replaced catalogs no reader can still hold.
+	The catalog replaced is freed later, by whichever writer next finds it unread
+@param live
+	A pointer to the live catalog
+@param next
+	The new catalog, allocated with malloc; the live catalog takes ownership of it
+*/
+void live_publish(LiveCatalog *live, Catalog *next) {
+	LiveRetired *retired = malloc(sizeof(LiveRetired));
+	if (retired == NULL) {
+		ERROR("Out of memory");
+	}
+	pthread_mutex_lock(&live->lock);
+	retired->catalog = atomic_exchange(&live->current, next);
+	retired->epoch = atomic_fetch_add(&live->epoch, 1) + 1;
+	retired->next = live->retired;
+	live->retired = retired;
+	pthread_mutex_unlock(&live->lock);
+	live_reclaim(live);
+}
+
+/**
+Load a catalog aside and publish it, leaving the current catalog in place if it fails to load
+@param live
+	A pointer to the live catalog
+@param path
+	The path of the new catalog, compiled or as text
+@return
+	Whether the new catalog was loaded and published
+*/
+bool live_reload(LiveCatalog *live, const char *path) {
+	Catalog *next = s_open(path);
+	if (next == NULL)
+		return false;
+	live_publish(live, next);
+	return true;
+}
+
+/**
+Free every replaced catalog no reader can still hold
+@param live
+	A pointer to the live catalog
+@return
+	The number of replaced catalogs still held by readers
+*/
+size_t live_reclaim(LiveCatalog *live) {
+	size_t held = 0;
+	pthread_mutex_lock(&live->lock);
+	for (LiveRetired **r = &live->retired; *r != NULL; ) {
+		LiveRetired *retired = *r;
+		if (s_passed(live, retired->epoch)) {
+			*r = retired->next;
+			s_destroy(retired->catalog);
+			free(retired);
+		}
+		else {
+			held++;
+			r = &retired->next;
+		}
+	}
+	pthread_mutex_unlock(&live->lock);
+	return held;
+}
+
+/**
+Free every catalog, waiting for readers to finish with those they hold
+@param live
+	A pointer to the live catalog
+*/
+void live_free(LiveCatalog *live) {
+	while (live_reclaim(live) > 0)
+		sched_yield();
+	s_destroy(atomic_load(&live->current));
+	pthread_mutex_destroy(&live->lock);
+}
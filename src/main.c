@@ -1,14 +1,428 @@
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "utils.h"
 #include "io.h"
+#include "arena.h"
+#include "catalog.h"
+#include "items.h"
+#include "daemon.h"
+#include "live.h"
+#include "publish.h"
+#include "journal.h"
+#include "pipeline.h"
+#include "running.h"
+#include "stats.h"
+#include "topk.h"
 
 
-int main(void) {
-	Currency total = 0;
+#define USAGE "usage: main.bin [-d SOCKET] [-f JOURNAL [-m] [-s] [-t K]] [-j JOURNAL [-r]] [-c CATALOG] [-p [SHM_NAME]]"
+
+
+// Read a line of input into memory taken from the arena, without its newline
+static char *s_read_line(Arena *arena, FILE *in) {
+	char *line = arena_alloc(arena, MAX_BUFFER_SIZE);
+	if (fgets(line, MAX_BUFFER_SIZE, in) == NULL)
+		return NULL;
+	line[strcspn(line, "\n")] = '\0';
+	return line;
+}
+
+// The journal accepted entries are appended to, and the aggregates of every entry in it
+typedef struct {
+	int fd;
+	bool readonly;          // Opened only to report on; neither the journal nor its checkpoint is written
+	StatsMark mark;         // Chars of the journal covered by stats
+	uint64 unsaved;         // Entries accepted since the last checkpoint
+	Stats stats;
+	char *checkpoint;
+} Ledger;
+
+
+// Check that a checkpoint's mark still matches the journal, which may have been replaced
+// 	or rewritten since rather than appended to
+static bool s_ledger_matches(const Ledger *ledger, const struct stat *st) {
+	uint64 fingerprint;
+	return ledger->mark.offset <= (uint64) st->st_size && ledger->mark.inode == st->st_ino
+			&& journal_fingerprint_fd(ledger->fd, ledger->mark.offset, &fingerprint)
+			&& fingerprint == ledger->mark.fingerprint;
+}
+
+// Checkpoint the aggregates, fingerprinting the journal chars they cover
+static bool s_ledger_save(Ledger *ledger) {
+	return journal_fingerprint_fd(ledger->fd, ledger->mark.offset, &ledger->mark.fingerprint)
+			&& stats_save(&ledger->stats, &ledger->mark, ledger->checkpoint);
+}
+
+// Open a journal, bringing its aggregates up to date from the last checkpoint by scanning
+// 	only the lines appended after it. A journal opened for appending has a last line cut
+// 	short completed, and is checkpointed; one opened read-only is left as it is, its
+// 	last line counted as it would be once completed
+static void s_ledger_open(Ledger *ledger, const char *path, bool readonly) {
+	struct stat st;
+	ledger->readonly = readonly;
+	ledger->unsaved = 0;
+	ledger->checkpoint = malloc(strlen(path) + sizeof(STATS_SUFFIX));
+	ledger->fd = readonly ? open(path, O_RDONLY) : open(path, O_RDWR | O_APPEND | O_CREAT, 0644);
+	if (ledger->checkpoint == NULL || ledger->fd < 0 || fstat(ledger->fd, &st) < 0) {
+		ERROR("Unable to open journal");
+	}
+	sprintf(ledger->checkpoint, "%s%s", path, STATS_SUFFIX);
+	size_t size = st.st_size;
+	char last;
+	bool cut = size > 0 && pread(ledger->fd, &last, 1, size - 1) == 1 && last != '\n';
+	// A last line cut short is completed, so entries appended after it stand alone
+	if (cut && !readonly && write(ledger->fd, "\n", 1) == 1) {
+		size++;
+		cut = false;
+	}
+	if (!stats_load(&ledger->stats, &ledger->mark, ledger->checkpoint) || !s_ledger_matches(ledger, &st)) {
+		stats_init(&ledger->stats);
+		ledger->mark.offset = 0;
+	}
+	ledger->mark.inode = st.st_ino;
+	if (ledger->mark.offset == size)
+		return;
+	char *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, ledger->fd, 0);
+	if (data == MAP_FAILED) {
+		ERROR("Unable to read journal");
+	}
+	ledger->mark.offset += stats_scan(&ledger->stats, data + ledger->mark.offset, size - ledger->mark.offset);
+	if (cut) {
+		size_t rest = size - ledger->mark.offset;
+		char *line = malloc(rest + 1);
+		if (line == NULL) {
+			ERROR("Out of memory");
+		}
+		memcpy(line, data + ledger->mark.offset, rest);
+		line[rest] = '\n';
+		stats_scan(&ledger->stats, line, rest + 1);
+		free(line);
+	}
+	munmap(data, size);
+	if (!readonly)
+		s_ledger_save(ledger);
+}
+
+// Account for an accepted entry, appending it to the journal if there is one
+static void s_ledger_accept(Ledger *ledger, const char *line, Currency amount) {
+	stats_add(&ledger->stats, amount);
+	if (ledger->fd < 0)
+		return;
+	size_t len = strlen(line);
+	if (!journal_append(ledger->fd, line, len)) {
+		ERROR("Unable to write journal");
+	}
+	ledger->mark.offset += len + 1;
+	if (++ledger->unsaved == STATS_INTERVAL) {
+		s_ledger_save(ledger);
+		ledger->unsaved = 0;
+	}
+}
+
+static void s_ledger_close(Ledger *ledger) {
+	if (ledger->fd < 0)
+		return;
+	if (!ledger->readonly && !s_ledger_save(ledger)) {
+		NONF_ERROR("Unable to save checkpoint");
+	}
+	close(ledger->fd);
+	free(ledger->checkpoint);
+}
+
+// Print the aggregates of accepted entries, with a line per non-empty histogram bucket
+static void s_print_report(const Stats *stats) {
+	printf("-- %lu entries\n", stats->count);
+	print_currency("-- sum %s\n", stats->sum);
+	print_currency("-- mean %s\n", stats_mean(stats));
+	print_currency("-- min %s\n", stats->count > 0 ? stats->min : 0);
+	print_currency("-- max %s\n", stats->max);
+	print_currency("-- p50 %s\n", sketch_quantile(&stats->quantiles, 0.50));
+	print_currency("-- p95 %s\n", sketch_quantile(&stats->quantiles, 0.95));
+	print_currency("-- p99 %s\n", sketch_quantile(&stats->quantiles, 0.99));
+	histogram_dump(&stats->histogram, stdout, "-- ");
+}
+
+// Print the sales of the current period, or of the period AGO periods before it
+static void s_print_sales(const ItemStore *items, const char *name, const char *rest) {
+	size_t ago = 0;
+	int len = 0;
+	if (*rest != '\0' && (sscanf(rest, "%zu %n", &ago, &len) != 1 || rest[len] != '\0')) {
+		NONF_ERROR("Invalid period");
+		return;
+	}
+	for (RollupPeriod p = 0; p < ROLLUP_PERIODS; p++) {
+		if (strcmp(name, rollup_period_name(p)) == 0) {
+			uint64 time = rollup_now() - ago * items->rollups.rings[p].width;
+			print_currency("-- %s\n", rollup_get(&items->rollups, p, time).total);
+			return;
+		}
+	}
+	NONF_ERROR("Invalid period");
+}
+
+// Carry out the command in line, if any, against the items of the tab; see docs/data.md.
+// 	The journal records entries only as accepted, so journaled entries cannot be changed
+static bool s_run_command(ItemStore *items, const Ledger *ledger, char *line) {
+	size_t n;
+	unsigned multiplier;
+	char amount_str[MAX_BUFFER_SIZE];
+	int len = 0;
+	if (sscanf(line, " void %zu %n", &n, &len) == 1 && line[len] == '\0') {
+		if (ledger->fd >= 0) {
+			NONF_ERROR("Journaled entries cannot be voided");
+		}
+		else if (n == 0 || !items_void(items, n-1)) {
+			NONF_ERROR("No such item to void");
+		}
+	}
+	else if (sscanf(line, " edit %zu %127s %n", &n, amount_str, &len) == 2 && line[len] == '\0') {
+		Currency amount = sscan_line_item(amount_str, &multiplier);
+		if (ledger->fd >= 0) {
+			NONF_ERROR("Journaled entries cannot be edited");
+		}
+		else if (multiplier == 0) {
+			NONF_ERROR("Invalid amount");
+		}
+		else if (n == 0 || !items_edit(items, n-1, amount, multiplier)) {
+			NONF_ERROR("No such item to edit");
+		}
+	}
+	else if (sscanf(line, " sub %zu %n", &n, &len) == 1 && line[len] == '\0') {
+		print_currency("-- %s\n", items_subtotal(items, n));
+	}
+	else if (sscanf(line, " sales %15s %n", amount_str, &len) == 1) {
+		s_print_sales(items, amount_str, line + len);
+	}
+	else if (sscanf(line, " report %n", &len) == 0 && len > 0 && line[len] == '\0') {
+		s_print_report(&ledger->stats);
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+// Scan an entry as an amount, or as #SKU[xN] if there is a catalog, printing the name of
+// 	the product scanned. The entry is rewritten as its amount, as the journal records it
+static Currency s_scan_entry(const Catalog *catalog, char *line, unsigned *multiplier) {
+	const CatalogEntry *product;
+	if (catalog == NULL || line[strspn(line, " \t")] != CATALOG_SKU_PREFIX)
+		return sscan_line_item(line, multiplier);
+	Currency amount = catalog_scan(catalog, line, strlen(line), multiplier, &product);
+	if (product == NULL) {
+		NONF_ERROR("No such product");
+		return 0;
+	}
+	if (*catalog_name(catalog, product) != '\0')
+		printf("-- %s\n", catalog_name(catalog, product));
+	if (*multiplier != 0)
+		sprintf(line, "%lu.%02lu", amount / 100, amount % 100);
+	return amount;
+}
+
+// Run the interactive register on stdin, publishing its total to shared memory if name is
+// 	set, appending accepted entries to the journal at journal_path if it is set, and
+// 	pricing SKUs from live if it is set
+static int s_repl(const char *publish_name, const char *journal_path, LiveCatalog *live) {
+	Arena arena;
+	ItemStore items;
+	Ledger ledger = {.fd = -1};
+	PublishedTotal *published = NULL;
+	LiveReader *reader = live != NULL ? live_register(live) : NULL;
+	Currency total, amount;
+	unsigned multiplier;
+	char *line;
+	arena_init(&arena, ARENA_CHUNK_SIZE);
+	items_init(&items);
+	stats_init(&ledger.stats);
+	if (journal_path != NULL)
+		s_ledger_open(&ledger, journal_path, false);
+	if (publish_name != NULL && (published = publish_open(publish_name)) == NULL) {
+		ERROR("Unable to open shared memory for publishing");
+	}
 	for (;;) {
+		total = items_subtotal(&items, items.count);
+		if (published != NULL)
+			publish_update(published, total, items.count);
 		print_currency("=> %s\n?> ", total);
-		total += scan_currency();
+		// Each entry is its own transaction; its memory is reclaimed before the next is read
+		arena_reset(&arena);
+		if ((line = s_read_line(&arena, stdin)) == NULL)
+			break;
+		if (s_run_command(&items, &ledger, line))
+			continue;
+		// Each entry is priced from one catalog, though it may be replaced while being scanned
+		amount = s_scan_entry(live != NULL ? live_enter(live, reader) : NULL, line, &multiplier);
+		if (live != NULL)
+			live_exit(reader);
+		if (multiplier == 0)  // Invalid entries add nothing, and are not kept
+			continue;
+		items_push(&items, amount, multiplier, ITEM_SALE);
+		s_ledger_accept(&ledger, line, amount);
+	}
+	s_ledger_close(&ledger);
+	if (published != NULL)
+		publish_close(published, publish_name);
+	items_free(&items);
+	arena_free(&arena);
+	return 0;
+}
+
+// Set before the reloader is sent its last SIGHUP
+static atomic_bool reloader_stopping = false;
+
+// Reload the catalog at path, passed as arg, each time the process is sent SIGHUP. SIGHUP
+// 	is blocked in every thread, and taken here by sigwait, so the register keeps scanning
+// 	while the new catalog is loaded
+static void *s_reload_catalog(void *arg) {
+	LiveCatalog *live = ((void**) arg)[0];
+	const char *path = ((void**) arg)[1];
+	sigset_t signals;
+	int sig;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGHUP);
+	while (sigwait(&signals, &sig) == 0 && !atomic_load(&reloader_stopping)) {
+		if (!live_reload(live, path)) {
+			NONF_ERROR("Unable to reload catalog; still using the last one loaded");
+		}
+	}
+	return NULL;
+}
+
+// Total a journal file, printing the result as the REPL would, then its k largest entries.
+// 	A mapped journal is scanned in place, rather than read through the pipeline
+static int s_total_journal(const char *path, bool mapped, size_t k) {
+	JournalTotal result;
+	TopK top;
+	TopEntry largest[TOPK_MAX];
+	topk_init(&top, k);
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		ERROR("Unable to open journal");
 	}
-	exit(0);
+	bool ok = mapped ? journal_total_mapped(fd, &result, &top) : pipeline_total(fd, INGEST_AUTO, &result, &top);
+	close(fd);
+	if (!ok) {
+		ERROR("Unable to read journal");
+	}
+	if (result.overflowed) {
+		NONF_ERROR("Total exceeds the largest amount; only its low 64 bits are shown");
+	}
+	print_currency("=> %s\n", result.total);
+	size_t n = topk_sorted(&top, largest);
+	for (size_t i = 0; i < n; i++) {
+		printf("-- line %lu ", largest[i].line);
+		print_currency("%s\n", largest[i].amount);
+	}
+	return 0;
+}
+
+// Print the running total after every line of a journal file, as the REPL would
+static int s_running_journal(const char *path) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		ERROR("Unable to open journal");
+	}
+	bool ok = running_totals(fd, STDOUT_FILENO, sysconf(_SC_NPROCESSORS_ONLN));
+	close(fd);
+	if (!ok) {
+		ERROR("Unable to read journal");
+	}
+	return 0;
 }
 
+
+int main(int argc, char **argv) {
+	const char *publish_name = NULL, *journal_path = NULL, *append_path = NULL, *catalog_path = NULL;
+	bool mapped = false, report = false, running = false;
+	long top_k = 0;
+	int opt;
+	while ((opt = getopt(argc, argv, "c:d:f:j:mp::rst:")) != -1) {
+		switch (opt) {
+		case 'c':
+			catalog_path = optarg;
+			break;
+		case 'd':
+			exit(daemon_run(optarg));
+		case 'f':
+			journal_path = optarg;
+			break;
+		case 'j':
+			append_path = optarg;
+			break;
+		case 'm':
+			mapped = true;
+			break;
+		case 'p':
+			// getopt only attaches an optional argument written as -pNAME, so take a
+			// 	separate operand too, as in -p NAME
+			if (optarg == NULL && optind < argc && argv[optind][0] != '-')
+				optarg = argv[optind++];
+			publish_name = optarg != NULL ? optarg : PUBLISH_DEFAULT_NAME;
+			break;
+		case 'r':
+			report = true;
+			break;
+		case 's':
+			running = true;
+			break;
+		case 't':
+			if ((top_k = atol(optarg)) <= 0 || top_k > TOPK_MAX) {
+				ERROR(USAGE);
+			}
+			break;
+		default:
+			ERROR(USAGE);
+		}
+	}
+	if (optind < argc) {
+		ERROR(USAGE);
+	}
+	if (journal_path != NULL && running) {
+		if (mapped || top_k > 0) {
+			ERROR(USAGE);
+		}
+		exit(s_running_journal(journal_path));
+	}
+	if (journal_path != NULL)
+		exit(s_total_journal(journal_path, mapped, top_k));
+	if (mapped || running || top_k > 0 || (report && append_path == NULL)) {
+		ERROR(USAGE);
+	}
+	if (report) {
+		Ledger ledger;
+		s_ledger_open(&ledger, append_path, true);
+		s_print_report(&ledger.stats);
+		s_ledger_close(&ledger);
+		exit(0);
+	}
+	if (catalog_path == NULL)
+		exit(s_repl(publish_name, append_path, NULL));
+	LiveCatalog live;
+	pthread_t reloader;
+	void *reload_args[] = {&live, (void*) catalog_path};
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGHUP);
+	pthread_sigmask(SIG_BLOCK, &signals, NULL);
+	if (!live_init(&live, catalog_path)) {
+		ERROR("Unable to load catalog");
+	}
+	if (pthread_create(&reloader, NULL, s_reload_catalog, reload_args) != 0) {
+		ERROR("Unable to start catalog reloader");
+	}
+	int status = s_repl(publish_name, append_path, &live);
+	atomic_store(&reloader_stopping, true);
+	pthread_kill(reloader, SIGHUP);
+	pthread_join(reloader, NULL);
+	live_free(&live);
+	exit(status);
+}
@@ -0,0 +1,188 @@
+#include <sched.h>
+#include <stdlib.h>
+
+#include "mpsc.h"
+#include "utils.h"
+
+
+/******
+ * Static Functions (marked with s_ prefix)
+ ******/
+
+// Drain the ring in batches until asked to stop, publishing the total after each batch
+static void *s_aggregate(void *arg) {
+	MpscAggregator *agg = arg;
+	Currency batch[MPSC_BATCH_SIZE];
+	Currency total = 0;
+	unsigned long applied = 0;
+	for (;;) {
+		size_t n = mpsc_pop_batch(agg->ring, batch, MPSC_BATCH_SIZE);
+		if (n == 0) {
+			// Producers have all finished once stopping is set, so an empty ring is final
+			if (atomic_load_explicit(&agg->stopping, memory_order_acquire)
+					&& mpsc_size(agg->ring) == 0)
+				break;
+			sched_yield();
+			continue;
+		}
+		for (size_t i = 0; i < n; i++)
+			total += batch[i];
+		applied += n;
+		atomic_store_explicit(&agg->total, total, memory_order_release);
+		atomic_store_explicit(&agg->applied, applied, memory_order_release);
+	}
+	return NULL;
+}
+
+
+/******
+ * Public Functions
+ ******/
+
+// ***** Ring
+
+/**
+Prepare an empty ring
+@param ring
+	A pointer to the ring to be initialized
+@param capacity
+	The number of entries the ring holds; must be a power of 2
+@return
+	Whether the ring was initialized; false if capacity is invalid or memory is exhausted
+*/
+bool mpsc_init(MpscRing *ring, size_t capacity) {
+	if (capacity < 2 || (capacity & (capacity - 1)) != 0)
+		return false;
+	ring->cells = aligned_alloc(CACHE_LINE_SIZE, CACHE_LINE_ROUND(capacity * sizeof(MpscCell)));
+	if (ring->cells == NULL)
+		return false;
+	for (size_t i = 0; i < capacity; i++)
+		atomic_init(&ring->cells[i].seq, i);
+	ring->mask = capacity - 1;
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->tail, 0);
+	atomic_init(&ring->rejected, 0);
+	return true;
+}
+
+/**
+Enqueue an entry without locking; safe to call from any number of threads at once
+@param ring
+	A pointer to the ring
+@param amount
+	The entry to be enqueued
+@return
+	Whether the entry was enqueued; false if the ring is full, in which case
+	the caller should back off and retry
+*/
+bool mpsc_push(MpscRing *ring, Currency amount) {
+	size_t pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	for (;;) {
+		MpscCell *cell = &ring->cells[pos & ring->mask];
+		size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+		long diff = (long) (seq - pos);
+		if (diff == 0) {
+			// The slot is free; claim the position, or learn which position to try next
+			if (atomic_compare_exchange_weak_explicit(&ring->tail, &pos, pos + 1,
+					memory_order_relaxed, memory_order_relaxed)) {
+				cell->value = amount;
+				atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+				return true;
+			}
+		}
+		else if (diff < 0) {
+			// The slot still holds an entry from a lap ago; the ring is full
+			atomic_fetch_add_explicit(&ring->rejected, 1, memory_order_relaxed);
+			return false;
+		}
+		else {
+			pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+		}
+	}
+}
+
+/**
+Dequeue up to max entries; must only be called from the single consumer thread
+@param ring
+	A pointer to the ring
+@param out
+	A pointer to where the dequeued entries are stored, in order
+@param max
+	The greatest number of entries to dequeue
+@return
+	The number of entries dequeued
+*/
+size_t mpsc_pop_batch(MpscRing *ring, Currency *out, size_t max) {
+	// Only this thread writes head, so it is kept in a local and published once per batch
+	size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	size_t n;
+	for (n = 0; n < max; n++) {
+		MpscCell *cell = &ring->cells[head & ring->mask];
+		size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+		if (seq != head + 1)
+			break;  // Empty, or the next producer has not finished writing
+		out[n] = cell->value;
+		// Free the slot for the producer that will reach it on the next lap
+		atomic_store_explicit(&cell->seq, head + ring->mask + 1, memory_order_release);
+		head++;
+	}
+	atomic_store_explicit(&ring->head, head, memory_order_release);
+	return n;
+}
+
+/**
+Estimate the number of entries waiting in the ring, as a measure of back-pressure; safe
+	to call from any thread. Head is acquired before tail is loaded, so the tail seen is
+	never behind the head, and the estimate never underflows
+@param ring
+	A pointer to the ring
+@return
+	The number of positions claimed by producers but not yet consumed
+*/
+size_t mpsc_size(MpscRing *ring) {
+	size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+	return atomic_load_explicit(&ring->tail, memory_order_relaxed) - head;
+}
+
+/**
+Free the memory held by a ring
+@param ring
+	A pointer to the ring to be freed
+*/
+void mpsc_free(MpscRing *ring) {
+	free(ring->cells);
+	ring->cells = NULL;
+}
+
+// ***** Aggregator
+
+/**
+Start a consumer thread applying a ring's entries to a running total, in batches
+@param agg
+	A pointer to the aggregator to be started
+@param ring
+	A pointer to the ring to be consumed
+@return
+	Whether the thread was started
+*/
+bool mpsc_aggregator_start(MpscAggregator *agg, MpscRing *ring) {
+	agg->ring = ring;
+	atomic_init(&agg->total, 0);
+	atomic_init(&agg->applied, 0);
+	atomic_init(&agg->stopping, false);
+	return pthread_create(&agg->thread, NULL, s_aggregate, agg) == 0;
+}
+
+/**
+Stop an aggregator once it has applied every entry in its ring. Producers must
+	have finished pushing before this is called
+@param agg
+	A pointer to the aggregator to be stopped
+@return
+	The final running total
+*/
+Currency mpsc_aggregator_stop(MpscAggregator *agg) {
+	atomic_store_explicit(&agg->stopping, true, memory_order_release);
+	pthread_join(agg->thread, NULL);
+	return atomic_load(&agg->total);
+}
@@ -0,0 +1,200 @@
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pipeline.h"
+#include "ingest.h"
+#include "journal.h"
+#include "spsc.h"
+#include "sum.h"
+#include "topk.h"
+#include "utils.h"
+
+
+/******
+ * Static Functions (marked with s_ prefix)
+ ******/
+
+// ***** Stages
+
+// Queue a read of the next PIPELINE_BUFFER_SIZE bytes of the journal into a buffer
+static void s_submit(Pipeline *p, PipelineBuffer *buf) {
+	ingest_submit(&p->ingest, buf - p->buffers, buf->base + PIPELINE_CARRY_SIZE, PIPELINE_BUFFER_SIZE);
+}
+
+// Keep INGEST_DEPTH large reads in flight, holding back each completed buffer until the
+// 	next arrives so its partial last line can be carried in front of the next one's data
+static void *s_read_stage(void *arg) {
+	Pipeline *p = arg;
+	PipelineBuffer *held = NULL, *buf;
+	bool end = false;
+	ssize_t n;
+	int i;
+	for (i = 0; i < INGEST_DEPTH; i++)
+		s_submit(p, spsc_pop_wait(&p->empty));
+	while ((i = ingest_wait(&p->ingest, &n)) >= 0) {
+		buf = &p->buffers[i];
+		if (end || n <= 0) {
+			// Reads queued past the end of the journal, or after it failed
+			p->failed |= n < 0;
+			end = true;
+			spsc_push_wait(&p->empty, buf);
+			continue;
+		}
+		end = n < PIPELINE_BUFFER_SIZE;
+		buf->data = buf->base + PIPELINE_CARRY_SIZE;
+		buf->len = n;
+		if (held != NULL) {
+			// Carry the partial last line in front of the next read. Only the last
+			// 	PIPELINE_CARRY_SIZE chars of a longer one fit, but that is far past
+			// 	MAX_BUFFER_SIZE, so it still scans as one invalid line; a buffer holding
+			// 	nothing but the middle of such a line is recycled unscanned
+			char *nl = memrchr(held->data, '\n', held->len);
+			size_t tail = nl != NULL ? (size_t) (held->data + held->len - (nl + 1)) : held->len;
+			size_t carry = tail < PIPELINE_CARRY_SIZE ? tail : PIPELINE_CARRY_SIZE;
+			buf->data -= carry;
+			buf->len += carry;
+			memcpy(buf->data, held->data + held->len - carry, carry);
+			held->len -= tail;
+			spsc_push_wait(held->len > 0 ? &p->filled : &p->empty, held);
+		}
+		held = buf;
+		if (!end)
+			s_submit(p, spsc_pop_wait(&p->empty));
+	}
+	// Hand over what remains, then an empty buffer to mark the end of input
+	if (held != NULL)
+		spsc_push_wait(&p->filled, held);
+	buf = spsc_pop_wait(&p->empty);
+	buf->len = 0;
+	spsc_push_wait(&p->filled, buf);
+	return NULL;
+}
+
+// Split buffers into lines and scan each one, passing the amounts on in batches
+static void *s_parse_stage(void *arg) {
+	Pipeline *p = arg;
+	PipelineBatch *batch = spsc_pop_wait(&p->spent);
+	PipelineBuffer *buf;
+	size_t consumed;
+	batch->count = 0;
+	batch->last = false;
+	while ((buf = spsc_pop_wait(&p->filled))->len > 0) {
+		for (size_t offset = 0; offset < buf->len; offset += consumed) {
+			batch->count += journal_parse(buf->data + offset, buf->len - offset, true,
+					batch->amounts + batch->count, PIPELINE_BATCH_SIZE - batch->count, &consumed);
+			if (batch->count == PIPELINE_BATCH_SIZE) {
+				spsc_push_wait(&p->parsed, batch);
+				batch = spsc_pop_wait(&p->spent);
+				batch->count = 0;
+				batch->last = false;
+			}
+		}
+		spsc_push_wait(&p->empty, buf);
+	}
+	batch->last = true;
+	spsc_push_wait(&p->parsed, batch);
+	return NULL;
+}
+
+// Sum batches of amounts until the last one arrives, offering each to top if set
+static void s_aggregate_stage(Pipeline *p, JournalTotal *out, TopK *top) {
+	PipelineBatch *batch;
+	Sum sum;
+	sum_init(&sum);
+	out->lines = 0;
+	do {
+		batch = spsc_pop_wait(&p->parsed);
+		sum_amounts(&sum, batch->amounts, batch->count, SUM_AUTO);
+		if (top != NULL)
+			topk_offer_batch(top, batch->amounts, batch->count, out->lines + 1);
+		out->lines += batch->count;
+		spsc_push_wait(&p->spent, batch);
+	} while (!batch->last);
+	out->total = sum.low;
+	out->overflowed = !sum_fits(&sum);
+}
+
+// ***** Setup
+
+// Allocate rings, buffers and batches, placing every buffer and batch in its free ring
+static bool s_pipeline_init(Pipeline *p) {
+	p->failed = false;
+	p->batches = malloc(PIPELINE_BATCHES * sizeof(PipelineBatch));
+	if (p->batches == NULL || !spsc_init(&p->filled, PIPELINE_BUFFERS)
+			|| !spsc_init(&p->empty, PIPELINE_BUFFERS) || !spsc_init(&p->parsed, PIPELINE_BATCHES)
+			|| !spsc_init(&p->spent, PIPELINE_BATCHES))
+		return false;
+	for (int i = 0; i < PIPELINE_BUFFERS; i++) {
+		// The carry space is a whole page, so reads land on page boundaries
+		p->buffers[i].base = aligned_alloc(PIPELINE_CARRY_SIZE, PIPELINE_CARRY_SIZE + PIPELINE_BUFFER_SIZE);
+		if (p->buffers[i].base == NULL)
+			return false;
+		spsc_push(&p->empty, &p->buffers[i]);
+	}
+	for (int i = 0; i < PIPELINE_BATCHES; i++)
+		spsc_push(&p->spent, &p->batches[i]);
+	return true;
+}
+
+static void s_pipeline_free(Pipeline *p) {
+	for (int i = 0; i < PIPELINE_BUFFERS; i++)
+		free(p->buffers[i].base);
+	free(p->batches);
+	spsc_free(&p->filled);
+	spsc_free(&p->empty);
+	spsc_free(&p->parsed);
+	spsc_free(&p->spent);
+}
+
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Total a journal through three stages: a reader thread, a parser thread, and the
+	calling thread as aggregator, so reading overlaps with scanning and summing.
+	The reader keeps several reads in flight, through io_uring where available
+@param fd
+	A file descriptor open for reading the journal
+@param mode
+	How the journal is read; see ingest_init
+@param out
+	A pointer to where the journal's total and line count are stored
+@param top
+	A pointer to a tracker offered every entry with its line number; may be NULL
+@return
+	Whether the whole journal was read
+*/
+bool pipeline_total(int fd, IngestMode mode, JournalTotal *out, TopK *top) {
+	Pipeline *p = calloc(1, sizeof(Pipeline));
+	pthread_t reader, parser;
+	if (p == NULL || !s_pipeline_init(p)) {
+		ERROR("Out of memory");
+	}
+	char *bases[PIPELINE_BUFFERS];
+	for (int i = 0; i < PIPELINE_BUFFERS; i++)
+		bases[i] = p->buffers[i].base;
+	if (!ingest_init(&p->ingest, fd, mode, bases, PIPELINE_BUFFERS, PIPELINE_CARRY_SIZE + PIPELINE_BUFFER_SIZE)) {
+		s_pipeline_free(p);
+		free(p);
+		return false;
+	}
+	if (pthread_create(&reader, NULL, s_read_stage, p) != 0
+			|| pthread_create(&parser, NULL, s_parse_stage, p) != 0) {
+		ERROR("Unable to start pipeline threads");
+	}
+	s_aggregate_stage(p, out, top);
+	pthread_join(reader, NULL);
+	pthread_join(parser, NULL);
+	ingest_close(&p->ingest);
+	bool ok = !p->failed;
+	s_pipeline_free(p);
+	free(p);
+	return ok;
+}
@@ -0,0 +1,232 @@
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pool.h"
+#include "utils.h"
+
+
+/******
+ * Static Variables
+ ******/
+
+// Index of the calling thread's deque, if it is a worker of the pool it belongs to
+static _Thread_local Pool *worker_pool = NULL;
+static _Thread_local size_t worker_index;
+
+
+/******
+ * Static Functions (marked with s_ prefix)
+ ******/
+
+// ***** Deques
+
+static void s_deque_push(PoolDeque *d, PoolTask task) {
+	pthread_mutex_lock(&d->lock);
+	if (d->tail == d->capacity) {
+		if (d->head > 0) {
+			// Reclaim the space freed by thieves before growing
+			memmove(d->tasks, d->tasks + d->head, (d->tail - d->head) * sizeof(PoolTask));
+			d->tail -= d->head;
+			d->head = 0;
+		}
+		else {
+			size_t capacity = d->capacity ? 2 * d->capacity : POOL_MIN_TASKS;
+			PoolTask *tasks = realloc(d->tasks, capacity * sizeof(PoolTask));
+			if (tasks == NULL) {
+				ERROR("Out of memory");
+			}
+			d->tasks = tasks;
+			d->capacity = capacity;
+		}
+	}
+	d->tasks[d->tail++] = task;
+	pthread_mutex_unlock(&d->lock);
+}
+
+// Take the newest task, for the deque's own worker; its data is most likely still in cache
+static bool s_deque_pop(PoolDeque *d, PoolTask *out) {
+	bool found = false;
+	pthread_mutex_lock(&d->lock);
+	if (d->tail > d->head) {
+		*out = d->tasks[--d->tail];
+		found = true;
+	}
+	pthread_mutex_unlock(&d->lock);
+	return found;
+}
+
+// Take the oldest task, for a thief; older tasks tend to be the largest
+static bool s_deque_steal(PoolDeque *d, PoolTask *out) {
+	bool found = false;
+	if (pthread_mutex_trylock(&d->lock) != 0)
+		return false;  // Contended; another deque is worth trying first
+	if (d->tail > d->head) {
+		*out = d->tasks[d->head++];
+		found = true;
+	}
+	pthread_mutex_unlock(&d->lock);
+	return found;
+}
+
+// ***** Workers
+
+// Find a task in the worker's own deque, or else steal one from another worker
+static bool s_find_task(Pool *pool, size_t self, PoolTask *out) {
+	if (s_deque_pop(&pool->deques[self], out))
+		return true;
+	for (size_t i = 1; i < pool->workers; i++) {
+		if (s_deque_steal(&pool->deques[(self + i) % pool->workers], out))
+			return true;
+	}
+	return false;
+}
+
+// Sleep until a task is queued or the pool stops. Sleepers are counted before queued is
+// 	checked, and submitters count queued tasks before checking for sleepers, so one of
+// 	the two always sees the other and no wakeup is lost
+static void s_sleep(Pool *pool) {
+	pthread_mutex_lock(&pool->idle_lock);
+	atomic_fetch_add(&pool->sleepers, 1);
+	if (atomic_load(&pool->queued) == 0 && !atomic_load(&pool->stopping))
+		pthread_cond_wait(&pool->wake, &pool->idle_lock);
+	atomic_fetch_sub(&pool->sleepers, 1);
+	pthread_mutex_unlock(&pool->idle_lock);
+}
+
+static void *s_worker(void *arg) {
+	Pool *pool = arg;
+	PoolTask task;
+	unsigned idle = 0;
+	worker_pool = pool;
+	worker_index = atomic_fetch_add(&pool->started, 1);
+	while (!atomic_load_explicit(&pool->stopping, memory_order_acquire)) {
+		if (s_find_task(pool, worker_index, &task)) {
+			idle = 0;
+			atomic_fetch_sub(&pool->queued, 1);
+			task.fn(pool, task.arg);
+			if (atomic_fetch_sub_explicit(&pool->pending, 1, memory_order_release) == 1) {
+				pthread_mutex_lock(&pool->idle_lock);
+				pthread_cond_broadcast(&pool->done);
+				pthread_mutex_unlock(&pool->idle_lock);
+			}
+		}
+		else if (++idle < POOL_SPINS) {
+			sched_yield();
+		}
+		else {
+			s_sleep(pool);
+			idle = 0;
+		}
+	}
+	return NULL;
+}
+
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Start a pool of worker threads
+@param workers
+	The number of worker threads
+@return
+	A pointer to the pool, or NULL if it could not be started
+*/
+Pool *pool_create(size_t workers) {
+	if (workers == 0)
+		return NULL;
+	Pool *pool = calloc(1, sizeof(Pool));
+	if (pool == NULL)
+		return NULL;
+	pool->deques = aligned_alloc(CACHE_LINE_SIZE, CACHE_LINE_ROUND(workers * sizeof(PoolDeque)));
+	pool->threads = malloc(workers * sizeof(pthread_t));
+	if (pool->deques == NULL || pool->threads == NULL) {
+		free(pool->deques);
+		free(pool->threads);
+		free(pool);
+		return NULL;
+	}
+	pool->workers = workers;
+	for (size_t i = 0; i < workers; i++) {
+		pthread_mutex_init(&pool->deques[i].lock, NULL);
+		pool->deques[i].tasks = NULL;
+		pool->deques[i].head = pool->deques[i].tail = pool->deques[i].capacity = 0;
+	}
+	atomic_init(&pool->pending, 0);
+	atomic_init(&pool->queued, 0);
+	atomic_init(&pool->sleepers, 0);
+	atomic_init(&pool->next, 0);
+	atomic_init(&pool->started, 0);
+	atomic_init(&pool->stopping, false);
+	pthread_mutex_init(&pool->idle_lock, NULL);
+	pthread_cond_init(&pool->wake, NULL);
+	pthread_cond_init(&pool->done, NULL);
+	for (size_t i = 0; i < workers; i++) {
+		if (pthread_create(&pool->threads[i], NULL, s_worker, pool) != 0) {
+			ERROR("Unable to start pool threads");
+		}
+	}
+	return pool;
+}
+
+/**
+Submit a task to a pool. Tasks submitted by a worker go to its own deque, where
+	idle workers may steal them; others are spread across the workers in turn
+@param pool
+	A pointer to the pool
+@param fn
+	The function to run, which is passed the pool and arg
+@param arg
+	The argument passed to fn
+*/
+void pool_submit(Pool *pool, PoolTaskFn fn, void *arg) {
+	PoolTask task = {fn, arg};
+	size_t i = worker_pool == pool ? worker_index : atomic_fetch_add(&pool->next, 1) % pool->workers;
+	atomic_fetch_add_explicit(&pool->pending, 1, memory_order_relaxed);
+	atomic_fetch_add(&pool->queued, 1);     // Before the push, so a taker never sees it go below 0
+	s_deque_push(&pool->deques[i], task);
+	if (atomic_load(&pool->sleepers) > 0) {
+		pthread_mutex_lock(&pool->idle_lock);
+		pthread_cond_signal(&pool->wake);
+		pthread_mutex_unlock(&pool->idle_lock);
+	}
+}
+
+/**
+Wait until every task submitted to a pool, including tasks submitted by other
+	tasks, has finished
+@param pool
+	A pointer to the pool
+*/
+void pool_wait(Pool *pool) {
+	pthread_mutex_lock(&pool->idle_lock);
+	while (atomic_load_explicit(&pool->pending, memory_order_acquire) > 0)
+		pthread_cond_wait(&pool->done, &pool->idle_lock);
+	pthread_mutex_unlock(&pool->idle_lock);
+}
+
+/**
+Stop a pool's workers once their current tasks finish, and free the pool
+@param pool
+	A pointer to the pool to be destroyed
+*/
+void pool_destroy(Pool *pool) {
+	atomic_store(&pool->stopping, true);
+	pthread_mutex_lock(&pool->idle_lock);
+	pthread_cond_broadcast(&pool->wake);
+	pthread_mutex_unlock(&pool->idle_lock);
+	for (size_t i = 0; i < pool->workers; i++)
+		pthread_join(pool->threads[i], NULL);
+	for (size_t i = 0; i < pool->workers; i++) {
+		pthread_mutex_destroy(&pool->deques[i].lock);
+		free(pool->deques[i].tasks);
+	}
+	pthread_mutex_destroy(&pool->idle_lock);
+	pthread_cond_destroy(&pool->wake);
+	pthread_cond_destroy(&pool->done);
+	free(pool->deques);
+	free(pool->threads);
+	free(pool);
+}
@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "prefix.h"
+#include "journal.h"
+#include "utils.h"
+
+
+#define BATCH_SIZE 4096
+
+
+// Layout of an index file, followed by its samples
+typedef struct {
+	uint32 magic;
+	uint32 version;
+	uint32 stride;
+	uint32 reserved;
+	uint64 entries;
+	uint64 covered;
+	uint64 fingerprint;
+	Currency total;
+	uint64 count;
+} PrefixHeader;
+
+
+/******
+ * Static Functions (marked with s_ prefix)
+ ******/
+
+static void s_push_sample(PrefixIndex *idx, uint64 offset, Currency sum) {
+	if (idx->count == idx->capacity) {
+		size_t capacity = idx->capacity ? 2 * idx->capacity : PREFIX_MIN_CAPACITY;
+		PrefixSample *samples = realloc(idx->samples, capacity * sizeof(PrefixSample));
+		if (samples == NULL) {
+			ERROR("Out of memory");
+		}
+		idx->samples = samples;
+		idx->capacity = capacity;
+	}
+	idx->samples[idx->count++] = (PrefixSample) {offset, sum};
+}
+
+// Sum the next n complete lines of a journal
+static Currency s_sum_lines(const char *data, size_t len, uint64 n) {
+	Currency amounts[BATCH_SIZE], sum = 0;
+	size_t got, consumed;
+	while (n > 0) {
+		got = journal_parse(data, len, false, amounts, n < BATCH_SIZE ? n : BATCH_SIZE, &consumed);
+		if (got == 0)
+			break;
+		for (size_t i = 0; i < got; i++)
+			sum += amounts[i];
+		data += consumed;
+		len -= consumed;
+		n -= got;
+	}
+	return sum;
+}
+
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Prepare an empty index, covering none of its journal
+@param idx
+	A pointer to the index to be initialized
+@param stride
+	The number of entries between samples; range totals scan fewer than 2 * stride lines
+*/
+void prefix_init(PrefixIndex *idx, uint32 stride) {
+	idx->stride = stride > 0 ? stride : PREFIX_DEFAULT_STRIDE;
+	idx->entries = 0;
+	idx->covered = 0;
+	idx->fingerprint = journal_fingerprint("", 0, 0);
+	idx->total = 0;
+	idx->samples = NULL;
+	idx->count = idx->capacity = 0;
+	s_push_sample(idx, 0, 0);
+}
+
+/**
+Extend an index over the lines appended to its journal since it was last updated.
+	Only complete lines are indexed; a partial last line waits for its newline
+@param idx
+	A pointer to the index to be updated
+@param data
+	The whole journal, as in memory
+@param len
+	The number of chars in the journal
+@return
+	Whether the index could be extended; false if the journal is shorter than the
+	index, or its chars covered no longer match the index's fingerprint, so it was
+	rewritten rather than appended to and the index must be rebuilt
+*/
+bool prefix_update(PrefixIndex *idx, const char *data, size_t len) {
+	Currency amounts[BATCH_SIZE];
+	size_t n, consumed;
+	if (len < idx->covered || journal_fingerprint(data, idx->covered, idx->covered) != idx->fingerprint)
+		return false;
+	while (idx->covered < len) {
+		// Stop at each sample boundary, to record where the next sample begins
+		uint64 want = idx->stride - idx->entries % idx->stride;
+		n = journal_parse(data + idx->covered, len - idx->covered, false, amounts,
+				want < BATCH_SIZE ? want : BATCH_SIZE, &consumed);
+		if (n == 0)
+			break;
+		for (size_t i = 0; i < n; i++)
+			idx->total += amounts[i];
+		idx->entries += n;
+		idx->covered += consumed;
+		if (idx->entries % idx->stride == 0)
+			s_push_sample(idx, idx->covered, idx->total);
+	}
+	idx->fingerprint = journal_fingerprint(data, idx->covered, idx->covered);
+	return true;
+}
+
+/**
+Total the first n entries of a journal from the nearest sample, scanning fewer than
+	stride lines
+@param idx
+	A pointer to the index of the journal
+@param data
+	The journal, as in memory
+@param n
+	The number of entries to total
+@param out
+	A pointer to where the total is stored
+@return
+	Whether the index covers n entries
+*/
+bool prefix_total(const PrefixIndex *idx, const char *data, uint64 n, Currency *out) {
+	if (n > idx->entries)
+		return false;
+	const PrefixSample *s = &idx->samples[n / idx->stride];
+	*out = s->sum + s_sum_lines(data + s->offset, idx->covered - s->offset, n % idx->stride);
+	return true;
+}
+
+/**
+Total a range of entries of a journal
+@param idx
+	A pointer to the index of the journal
+@param data
+	The journal, as in memory
+@param first
+	The 1-based number of the first entry in the range, as the REPL numbers items
+@param last
+	The 1-based number of the last entry in the range, inclusive
+@param out
+	A pointer to where the total is stored
+@return
+	Whether the range is valid and covered by the index
+*/
+bool prefix_range(const PrefixIndex *idx, const char *data, uint64 first, uint64 last, Currency *out) {
+	Currency before, through;
+	if (first == 0 || first > last || !prefix_total(idx, data, first - 1, &before)
+			|| !prefix_total(idx, data, last, &through))
+		return false;
+	*out = through - before;
+	return true;
+}
+
+/**
+Read an index from its file
+@param idx
+	A pointer to the index to be initialized from the file
+@param path
+	The path to the index file
+@return
+	Whether a valid index was read; if not, idx is left uninitialized
+*/
+bool prefix_load(PrefixIndex *idx, const char *path) {
+	PrefixHeader h;
+	FILE *file = fopen(path, "rb");
+	if (file == NULL)
+		return false;
+	bool ok = fread(&h, sizeof(h), 1, file) == 1 && h.magic == PREFIX_MAGIC
+			&& h.version == PREFIX_VERSION && h.stride > 0 && h.count > 0
+			&& h.count == h.entries / h.stride + 1;
+	if (ok) {
+		idx->stride = h.stride;
+		idx->entries = h.entries;
+		idx->covered = h.covered;
+		idx->fingerprint = h.fingerprint;
+		idx->total = h.total;
+		idx->count = idx->capacity = h.count;
+		idx->samples = malloc(h.count * sizeof(PrefixSample));
+		if (idx->samples == NULL) {
+			ERROR("Out of memory");
+		}
+		ok = fread(idx->samples, sizeof(PrefixSample), h.count, file) == h.count;
+		if (!ok)
+			free(idx->samples);
+	}
+	fclose(file);
+	return ok;
+}
+
+/**
+Write an index to its file, replacing any previous version at once
+@param idx
+	A pointer to the index to be written
+@param path
+	The path to the index file
+@return
+	Whether the index was written
+*/
+bool prefix_save(const PrefixIndex *idx, const char *path) {
+	PrefixHeader h = {PREFIX_MAGIC, PREFIX_VERSION, idx->stride, 0, idx->entries, idx->covered,
+			idx->fingerprint, idx->total, idx->count};
+	char tmp[strlen(path) + 5];
+	snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+	FILE *file = fopen(tmp, "wb");
+	if (file == NULL)
+		return false;
+	bool ok = fwrite(&h, sizeof(h), 1, file) == 1
+			&& fwrite(idx->samples, sizeof(PrefixSample), idx->count, file) == idx->count;
+	ok = fclose(file) == 0 && ok;
+	if (ok)
+		ok = rename(tmp, path) == 0;
+	else
+		remove(tmp);
+	return ok;
+}
+
+/**
+Release the memory held by an index
+@param idx
+	A pointer to the index to be freed
+*/
+void prefix_free(PrefixIndex *idx) {
+	free(idx->samples);
+	idx->samples = NULL;
+	idx->count = idx->capacity = 0;
+}
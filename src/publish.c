@@ -0,0 +1,129 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "publish.h"
+#include "utils.h"
+
+
+/******
+ * Static Functions (marked with s_ prefix)
+ ******/
+
+// Map the named shared memory segment, creating it if the caller will write to it
+static void *s_map(const char *name, bool writable) {
+	int fd = shm_open(name, writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+	if (fd < 0)
+		return NULL;
+	if (writable && ftruncate(fd, sizeof(PublishedTotal)) < 0) {
+		close(fd);
+		return NULL;
+	}
+	void *out = mmap(NULL, sizeof(PublishedTotal), writable ? PROT_READ | PROT_WRITE : PROT_READ,
+			MAP_SHARED, fd, 0);
+	close(fd);
+	return out == MAP_FAILED ? NULL : out;
+}
+
+
+/******
+ * Public Functions
+ ******/
+
+// ***** Register
+
+/**
+Create a shared memory segment through which a register publishes its running total
+@param name
+	The name of the segment, beginning with a slash, ie: "/CashRegister"
+@return
+	A pointer to the mapped segment, or NULL on failure
+*/
+PublishedTotal *publish_open(const char *name) {
+	PublishedTotal *published = s_map(name, true);
+	if (published != NULL)
+		publish_update(published, 0, 0);
+	return published;
+}
+
+/**
+Publish a new running total. Readers are never waited on; any read overlapping
+	the update sees the sequence number change and retries
+@param published
+	A pointer to the mapped segment
+@param total
+	The running total
+@param count
+	The number of entries making up the total
+*/
+void publish_update(PublishedTotal *published, Currency total, uint64 count) {
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	uint64 seq = atomic_load_explicit(&published->seq, memory_order_relaxed);
+	atomic_store_explicit(&published->seq, seq + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	atomic_store_explicit(&published->total, total, memory_order_relaxed);
+	atomic_store_explicit(&published->count, count, memory_order_relaxed);
+	atomic_store_explicit(&published->updated_ns, now.tv_sec * 1000000000UL + now.tv_nsec,
+			memory_order_relaxed);
+	atomic_store_explicit(&published->seq, seq + 2, memory_order_release);
+}
+
+/**
+Unmap and remove a register's shared memory segment. Readers still attached keep
+	their mapping until they detach
+@param published
+	A pointer to the mapped segment
+@param name
+	The name the segment was opened with
+*/
+void publish_close(PublishedTotal *published, const char *name) {
+	munmap(published, sizeof(PublishedTotal));
+	shm_unlink(name);
+}
+
+// ***** Readers
+
+/**
+Map a register's shared memory segment for reading
+@param name
+	The name of the segment, as given to publish_open
+@return
+	A pointer to the mapped segment, or NULL if it does not exist
+*/
+const PublishedTotal *publish_attach(const char *name) {
+	return s_map(name, false);
+}
+
+/**
+Take a consistent snapshot of a published total, without system calls or locks
+@param published
+	A pointer to the mapped segment
+@return
+	The published fields, all from the same update
+*/
+TotalSnapshot publish_read(const PublishedTotal *published) {
+	TotalSnapshot out;
+	uint64 before, after;
+	for (;;) {
+		before = atomic_load_explicit(&published->seq, memory_order_acquire);
+		out.total = atomic_load_explicit(&published->total, memory_order_relaxed);
+		out.count = atomic_load_explicit(&published->count, memory_order_relaxed);
+		out.updated_ns = atomic_load_explicit(&published->updated_ns, memory_order_relaxed);
+		atomic_thread_fence(memory_order_acquire);
+		after = atomic_load_explicit(&published->seq, memory_order_relaxed);
+		// Updates take nanoseconds, so retry at once rather than yield
+		if (before == after && (before & 1) == 0)
+			return out;
+	}
+}
+
+/**
+Unmap a register's shared memory segment from a reader
+@param published
+	A pointer to the mapped segment
+*/
+void publish_detach(const PublishedTotal *published) {
+	munmap((void*) published, sizeof(PublishedTotal));
+}
@@ -0,0 +1,109 @@
+#include <string.h>
+#include <time.h>
+
+#include "rollup.h"
+#include "utils.h"
+
+
+static const char *period_names[ROLLUP_PERIODS] = {"minute", "hour", "day"};
+
+
+/******
+ * Static Functions (marked with s_ prefix)
+ ******/
+
+static void s_ring_init(RollupRing *ring, uint64 seconds, size_t size) {
+	ring->width = seconds * ROLLUP_NS_PER_SEC;
+	ring->size = size;
+	memset(ring->buckets, 0, sizeof(ring->buckets));
+}
+
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Prepare empty rollups, aligned to the local time zone as it stands now
+@param rollups
+	A pointer to the rollups to be initialized
+*/
+void rollup_init(Rollups *rollups) {
+	struct tm local;
+	time_t now = time(NULL);
+	rollups->offset = localtime_r(&now, &local) != NULL ? local.tm_gmtoff * ROLLUP_NS_PER_SEC : 0;
+	s_ring_init(&rollups->rings[ROLLUP_MINUTE], 60, ROLLUP_MINUTES);
+	s_ring_init(&rollups->rings[ROLLUP_HOUR], 60 * 60, ROLLUP_HOURS);
+	s_ring_init(&rollups->rings[ROLLUP_DAY], 24 * 60 * 60, ROLLUP_DAYS);
+}
+
+/**
+Read the time cheaply enough to stamp every entry. The coarse clock is served from
+	the vDSO without a system call, at the resolution of a scheduler tick
+@return
+	Nanoseconds since the epoch
+*/
+uint64 rollup_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+	return (uint64) ts.tv_sec * ROLLUP_NS_PER_SEC + ts.tv_nsec;
+}
+
+/**
+Add to the sales of the periods containing a given time, in O(1). A bucket is reused
+	once its slot comes around to a later period; changes to periods older than
+	those kept are dropped
+@param rollups
+	A pointer to the rollups to be updated
+@param time
+	The time the sale was entered, in nanoseconds since the epoch
+@param amount
+	The amount to add; pass the negation of an amount to subtract it
+@param count
+	The change in the number of sales, ie: 1 for a sale, -1 for a void, 0 for an edit
+*/
+void rollup_add(Rollups *rollups, uint64 time, Currency amount, int count) {
+	uint64 local = time + rollups->offset;
+	for (int p = 0; p < ROLLUP_PERIODS; p++) {
+		RollupRing *ring = &rollups->rings[p];
+		uint64 period = local / ring->width;
+		RollupBucket *b = &ring->buckets[period % ring->size];
+		if (period < b->period)
+			continue;
+		if (period > b->period)
+			*b = (RollupBucket) {period, 0, 0};
+		b->total += amount;
+		b->count += count;
+	}
+}
+
+/**
+Look up the sales of the period containing a given time, in O(1)
+@param rollups
+	A pointer to the rollups to be read
+@param period
+	The length of period, ie: ROLLUP_HOUR for the sales of an hour
+@param time
+	A time within the period, in nanoseconds since the epoch
+@return
+	The sales of the period; empty if it saw none or is older than those kept
+*/
+RollupBucket rollup_get(const Rollups *rollups, RollupPeriod period, uint64 time) {
+	const RollupRing *ring = &rollups->rings[period];
+	uint64 index = (time + rollups->offset) / ring->width;
+	RollupBucket b = ring->buckets[index % ring->size];
+	if (b.period != index)
+		b = (RollupBucket) {index, 0, 0};
+	return b;
+}
+
+/**
+Name a length of period, as given to the sales command
+@param period
+	The length of period
+@return
+	The period's name, ie: "hour"
+*/
+const char *rollup_period_name(RollupPeriod period) {
+	return period_names[period];
+}
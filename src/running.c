@@ -0,0 +1,171 @@
+#include <errno.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "running.h"
+#include "io.h"
+#include "journal.h"
+#include "pool.h"
+#include "sum.h"
+#include "utils.h"
+
+
+#define LINE_PREFIX "=> "
+#define LINE_MAX (sizeof(LINE_PREFIX) + MAX_BUFFER_SIZE + 1)  // A formatted line, with its newline
+
+
+/******
+ * Static Functions (marked with s_ prefix)
+ ******/
+
+// First pass: total a chunk's lines
+static void s_sum_chunk(Pool *pool, void *arg) {
+	(void) pool;
+	RunningChunk *chunk = arg;
+	Currency amounts[RUNNING_BATCH];
+	size_t offset = 0, consumed, n;
+	Sum sum;
+	sum_init(&sum);
+	while (offset < chunk->len) {
+		n = journal_parse(chunk->data + offset, chunk->len - offset, true, amounts, RUNNING_BATCH, &consumed);
+		sum_amounts(&sum, amounts, n, SUM_AUTO);
+		offset += consumed;
+	}
+	chunk->sum = sum.low;  // Wraps like the REPL's total, should it ever exceed a Currency
+}
+
+// Second pass: rescan a chunk from the total preceding it, formatting the running total
+// 	after each line, as the REPL prints it
+static void s_format_chunk(Pool *pool, void *arg) {
+	(void) pool;
+	RunningChunk *chunk = arg;
+	Currency amounts[RUNNING_BATCH], running = chunk->offset;
+	size_t offset = 0, consumed, n, capacity = chunk->len * 2 + LINE_MAX;
+	if ((chunk->out = malloc(capacity)) == NULL) {
+		ERROR("Out of memory");
+	}
+	chunk->out_len = 0;
+	while (offset < chunk->len) {
+		n = journal_parse(chunk->data + offset, chunk->len - offset, true, amounts, RUNNING_BATCH, &consumed);
+		for (size_t i = 0; i < n; i++) {
+			if (capacity - chunk->out_len < LINE_MAX) {
+				capacity *= 2;
+				if ((chunk->out = realloc(chunk->out, capacity)) == NULL) {
+					ERROR("Out of memory");
+				}
+			}
+			char *p = chunk->out + chunk->out_len;
+			running += amounts[i];
+			memcpy(p, LINE_PREFIX, sizeof(LINE_PREFIX) - 1);
+			p += sizeof(LINE_PREFIX) - 1;
+			p += sprint_currency_r(p, MAX_BUFFER_SIZE, running);
+			*p++ = '\n';
+			chunk->out_len = p - chunk->out;
+		}
+		offset += consumed;
+	}
+	atomic_store_explicit(&chunk->done, true, memory_order_release);
+}
+
+// Write all of buf to fd, retrying short writes
+static bool s_write_all(int fd, const char *buf, size_t len) {
+	while (len > 0) {
+		ssize_t n = write(fd, buf, len);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		buf += n;
+		len -= n;
+	}
+	return true;
+}
+
+// Split a journal into chunks of at least RUNNING_CHUNK_SIZE chars, each ending on a line boundary
+static size_t s_split(const char *data, size_t len, RunningChunk *chunks) {
+	size_t count = 0, start = 0, end;
+	while (start < len) {
+		end = start + RUNNING_CHUNK_SIZE;
+		if (end >= len)
+			end = len;
+		else {
+			const char *nl = memchr(data + end - 1, '\n', len - end + 1);
+			end = nl != NULL ? (size_t) (nl + 1 - data) : len;
+		}
+		chunks[count].data = data + start;
+		chunks[count].len = end - start;
+		atomic_init(&chunks[count].done, false);
+		count++;
+		start = end;
+	}
+	return count;
+}
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Write the running total after every line of a journal, as the REPL prints "=> " lines.
+	Chunks of the journal are summed in parallel, then an exclusive scan of the sums
+	gives the total preceding each chunk, from which chunks are rescanned and formatted
+	in parallel. Formatted chunks are written in order as they finish, with a bounded
+	number formatted ahead of the writer
+@param in_fd
+	The journal's file descriptor, which must refer to a regular file
+@param out_fd
+	The file descriptor to which the running totals are written
+@param workers
+	The number of threads summing and formatting chunks
+@return
+	Whether the whole journal was read and its running totals written
+*/
+bool running_totals(int in_fd, int out_fd, size_t workers) {
+	struct stat st;
+	if (fstat(in_fd, &st) != 0 || !S_ISREG(st.st_mode))
+		return false;
+	size_t len = st.st_size;
+	if (len == 0)
+		return true;
+	char *data = mmap(NULL, len, PROT_READ, MAP_PRIVATE, in_fd, 0);
+	if (data == MAP_FAILED)
+		return false;
+	madvise(data, len, MADV_SEQUENTIAL);
+	RunningChunk *chunks = calloc(len / RUNNING_CHUNK_SIZE + 1, sizeof(RunningChunk));
+	Pool *pool = pool_create(workers);
+	if (chunks == NULL || pool == NULL) {
+		ERROR("Unable to start workers");
+	}
+	size_t count = s_split(data, len, chunks);
+
+	for (size_t i = 0; i < count; i++)
+		pool_submit(pool, s_sum_chunk, &chunks[i]);
+	pool_wait(pool);
+	Currency offset = 0;
+	for (size_t i = 0; i < count; i++) {
+		chunks[i].offset = offset;
+		offset += chunks[i].sum;
+	}
+
+	size_t window = workers * RUNNING_WINDOW, submitted = 0;
+	bool ok = true;
+	for (; submitted < count && submitted < window; submitted++)
+		pool_submit(pool, s_format_chunk, &chunks[submitted]);
+	for (size_t i = 0; i < count; i++) {
+		while (!atomic_load_explicit(&chunks[i].done, memory_order_acquire))
+			sched_yield();
+		ok = ok && s_write_all(out_fd, chunks[i].out, chunks[i].out_len);
+		free(chunks[i].out);
+		if (submitted < count)
+			pool_submit(pool, s_format_chunk, &chunks[submitted++]);
+	}
+	pool_wait(pool);
+	pool_destroy(pool);
+	free(chunks);
+	munmap(data, len);
+	return ok;
+}
@@ -0,0 +1,127 @@
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "shard.h"
+#include "utils.h"
+
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Prepare a sharded total of 0
+@param sharded
+	A pointer to the sharded total to be initialized
+@param count
+	The number of shards, which bounds the number of threads that may add to it
+@return
+	Whether the sharded total was initialized; false if memory is exhausted
+*/
+bool shard_init(ShardedTotal *sharded, size_t count) {
+	sharded->shards = aligned_alloc(CACHE_LINE_SIZE, CACHE_LINE_ROUND(count * sizeof(Shard)));
+	if (sharded->shards == NULL)
+		return false;
+	for (size_t i = 0; i < count; i++) {
+		atomic_init(&sharded->shards[i].total, 0);
+		atomic_init(&sharded->shards[i].seq, 0);
+	}
+	sharded->count = count;
+	atomic_init(&sharded->claimed, 0);
+	return true;
+}
+
+/**
+Claim a shard for the calling thread's exclusive use
+@param sharded
+	A pointer to the sharded total
+@return
+	The index of the claimed shard, or SHARD_NONE if every shard is taken
+*/
+size_t shard_claim(ShardedTotal *sharded) {
+	size_t i = atomic_fetch_add_explicit(&sharded->claimed, 1, memory_order_relaxed);
+	return i < sharded->count ? i : SHARD_NONE;
+}
+
+/**
+Add an amount to a shard. Only the thread that claimed the shard may add to it,
+	so this needs no atomic read-modify-write
+@param sharded
+	A pointer to the sharded total
+@param shard
+	The index of the caller's shard, as returned by shard_claim
+@param amount
+	The amount to be added
+*/
+void shard_add(ShardedTotal *sharded, size_t shard, Currency amount) {
+	Shard *s = &sharded->shards[shard];
+	Currency total = atomic_load_explicit(&s->total, memory_order_relaxed);
+	uint64 seq = atomic_load_explicit(&s->seq, memory_order_relaxed);
+	atomic_store_explicit(&s->seq, seq + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	atomic_store_explicit(&s->total, total + amount, memory_order_relaxed);
+	atomic_store_explicit(&s->seq, seq + 2, memory_order_release);
+}
+
+/**
+Combine every shard into a single total. Shards are read one by one while
+	writers continue, so the result may mix amounts added during the call
+@param sharded
+	A pointer to the sharded total
+@return
+	The sum of all shards
+*/
+Currency shard_sum(ShardedTotal *sharded) {
+	Currency sum = 0;
+	for (size_t i = 0; i < sharded->count; i++)
+		sum += atomic_load_explicit(&sharded->shards[i].total, memory_order_relaxed);
+	return sum;
+}
+
+/**
+Combine every shard into a total that existed at a single instant. Shards are
+	collected twice, and the collection is retried until no shard changed between
+	the two; a reader may wait while writers are continuously busy
+@param sharded
+	A pointer to the sharded total
+@param adds
+	A pointer to where the number of amounts in the snapshot is stored; may be NULL
+@return
+	The sum of all shards at the instant of the snapshot
+*/
+Currency shard_snapshot(ShardedTotal *sharded, uint64 *adds) {
+	for (;;) {
+		Currency sum = 0;
+		uint64 before = 0, after = 0;
+		bool writing = false;
+		for (size_t i = 0; i < sharded->count; i++) {
+			uint64 seq = atomic_load_explicit(&sharded->shards[i].seq, memory_order_acquire);
+			writing |= seq & 1;
+			before += seq;
+		}
+		for (size_t i = 0; i < sharded->count; i++)
+			sum += atomic_load_explicit(&sharded->shards[i].total, memory_order_relaxed);
+		atomic_thread_fence(memory_order_acquire);
+		for (size_t i = 0; i < sharded->count; i++)
+			after += atomic_load_explicit(&sharded->shards[i].seq, memory_order_relaxed);
+		// Sequence numbers only grow, so equal sums mean no shard changed in between
+		if (!writing && before == after) {
+			if (adds != NULL)
+				*adds = after / 2;
+			return sum;
+		}
+		sched_yield();
+	}
+}
+
+/**
+Free the shards of a sharded total
+@param sharded
+	A pointer to the sharded total to be freed
+*/
+void shard_free(ShardedTotal *sharded) {
+	free(sharded->shards);
+	sharded->shards = NULL;
+	sharded->count = 0;
+}
@@ -0,0 +1,183 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "sketch.h"
+#include "utils.h"
+
+
+// An amount and the number of amounts it stands for, as gathered for queries
+typedef struct {
+	Currency value;
+	uint64 weight;
+} Weighted;
+
+
+/******
+ * Static Functions (marked with s_ prefix)
+ ******/
+
+// Sort amounts with a byte-wise radix sort, which has no data-dependent branches to
+// 	mispredict, skipping bytes every amount shares; amounts are mostly small, so most
+// 	passes are skipped
+static void s_sort(Currency *values, size_t n) {
+	Currency tmp[SKETCH_K], *src = values, *dst = tmp, *swap;
+	Currency all_or = 0, all_and = (Currency) -1;
+	for (size_t i = 0; i < n; i++) {
+		all_or |= values[i];
+		all_and &= values[i];
+	}
+	for (unsigned shift = 0; shift < 64; shift += 8) {
+		if ((((all_or ^ all_and) >> shift) & 0xFF) == 0)
+			continue;
+		size_t counts[256] = {0}, sum = 0, c;
+		for (size_t i = 0; i < n; i++)
+			counts[(src[i] >> shift) & 0xFF]++;
+		for (size_t b = 0; b < 256; b++) {
+			c = counts[b];
+			counts[b] = sum;
+			sum += c;
+		}
+		for (size_t i = 0; i < n; i++)
+			dst[counts[(src[i] >> shift) & 0xFF]++] = src[i];
+		swap = src;
+		src = dst;
+		dst = swap;
+	}
+	if (src != values)
+		memcpy(values, src, n * sizeof(Currency));
+}
+
+// Draw a random bit, from an xorshift generator
+static unsigned s_coin(Sketch *sketch) {
+	sketch->seed ^= sketch->seed << 13;
+	sketch->seed ^= sketch->seed >> 7;
+	sketch->seed ^= sketch->seed << 17;
+	return sketch->seed & 1;
+}
+
+// Halve a level, promoting every other amount of its sorted order to the level above.
+// 	The largest amount of an odd level stays behind, so no weight is lost below the top
+// 	level. With no level above it, the top level is halved in place instead, and the
+// 	weight of the amounts it drops is lost; it is only ever full after some 2^40 amounts
+static void s_compact(Sketch *sketch, size_t h) {
+	size_t n = sketch->sizes[h], half = n / 2;
+	Currency *level = sketch->levels[h];
+	if (h + 1 == SKETCH_LEVELS) {
+		s_sort(level, n);
+		unsigned offset = s_coin(sketch);
+		for (size_t i = 0; i < half; i++)
+			level[i] = level[2*i + offset];
+		if (n % 2)
+			level[half] = level[n-1];
+		sketch->sizes[h] = half + n % 2;
+		return;
+	}
+	if (sketch->sizes[h+1] + half > SKETCH_K)
+		s_compact(sketch, h + 1);
+	Currency *above = sketch->levels[h+1];
+	s_sort(level, n);
+	unsigned offset = s_coin(sketch);
+	for (size_t i = 0; i < half; i++)
+		above[sketch->sizes[h+1]++] = level[2*i + offset];
+	if (n % 2)
+		level[0] = level[n-1];
+	sketch->sizes[h] = n % 2;
+}
+
+// Add an amount of weight 2^h
+static void s_insert(Sketch *sketch, size_t h, Currency amount) {
+	if (sketch->sizes[h] == SKETCH_K)
+		s_compact(sketch, h);
+	if (sketch->sizes[h] < SKETCH_K)
+		sketch->levels[h][sketch->sizes[h]++] = amount;
+}
+
+static int s_compare(const void *a, const void *b) {
+	Currency x = ((const Weighted*) a)->value, y = ((const Weighted*) b)->value;
+	return (x > y) - (x < y);
+}
+
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Prepare an empty sketch
+@param sketch
+	A pointer to the sketch to be initialized
+*/
+void sketch_init(Sketch *sketch) {
+	sketch->count = 0;
+	sketch->seed = 0x9E3779B97F4A7C15UL;
+	memset(sketch->sizes, 0, sizeof(sketch->sizes));
+}
+
+/**
+Add an amount to a sketch, in amortized O(1): a level is sorted once per SKETCH_K
+	amounts that reach it
+@param sketch
+	A pointer to the sketch receiving the amount
+@param amount
+	The amount to be added
+*/
+void sketch_add(Sketch *sketch, Currency amount) {
+	sketch->count++;
+	s_insert(sketch, 0, amount);
+}
+
+/**
+Merge the amounts of one sketch into another, level by level
+@param into
+	A pointer to the sketch receiving the amounts
+@param from
+	A pointer to the sketch to be merged; it is left unchanged
+*/
+void sketch_merge(Sketch *into, const Sketch *from) {
+	into->count += from->count;
+	for (size_t h = 0; h < SKETCH_LEVELS; h++) {
+		for (size_t i = 0; i < from->sizes[h]; i++)
+			s_insert(into, h, from->levels[h][i]);
+	}
+}
+
+/**
+Estimate a quantile of the amounts added to a sketch
+@param sketch
+	A pointer to the sketch to be queried
+@param q
+	The quantile, from 0 to 1; ie: 0.95 for the 95th percentile
+@return
+	The least amount estimated to be at or above a fraction q of all amounts;
+	0 if the sketch is empty
+*/
+Currency sketch_quantile(const Sketch *sketch, double q) {
+	Weighted *all = malloc(SKETCH_LEVELS * SKETCH_K * sizeof(Weighted));
+	size_t n = 0;
+	uint64 total = 0;
+	if (all == NULL) {
+		ERROR("Out of memory");
+	}
+	for (size_t h = 0; h < SKETCH_LEVELS; h++) {
+		for (size_t i = 0; i < sketch->sizes[h]; i++) {
+			all[n++] = (Weighted) {sketch->levels[h][i], 1UL << h};
+			total += 1UL << h;
+		}
+	}
+	Currency out = 0;
+	if (n > 0) {
+		qsort(all, n, sizeof(Weighted), s_compare);
+		double target = q * total;
+		uint64 seen = 0;
+		out = all[n-1].value;
+		for (size_t i = 0; i < n; i++) {
+			seen += all[i].weight;
+			if (seen >= target) {
+				out = all[i].value;
+				break;
+			}
+		}
+	}
+	free(all);
+	return out;
+}
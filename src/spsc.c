@@ -0,0 +1,101 @@
+#include <sched.h>
+#include <stdlib.h>
+
+#include "spsc.h"
+#include "utils.h"
+
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Prepare an empty ring
+@param ring
+	A pointer to the ring to be initialized
+@param capacity
+	The number of pointers the ring holds; must be a power of 2
+@return
+	Whether the ring was initialized; false if capacity is invalid or memory is exhausted
+*/
+bool spsc_init(SpscRing *ring, size_t capacity) {
+	if (capacity < 2 || (capacity & (capacity - 1)) != 0)
+		return false;
+	ring->slots = malloc(capacity * sizeof(void*));
+	if (ring->slots == NULL)
+		return false;
+	ring->mask = capacity - 1;
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->tail, 0);
+	return true;
+}
+
+/**
+Enqueue a pointer; must only be called from the producer thread
+@param ring
+	A pointer to the ring
+@param item
+	The pointer to be enqueued
+@return
+	Whether the pointer was enqueued; false if the ring is full
+*/
+bool spsc_push(SpscRing *ring, void *item) {
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	if (tail - atomic_load_explicit(&ring->head, memory_order_acquire) > ring->mask)
+		return false;
+	ring->slots[tail & ring->mask] = item;
+	atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+	return true;
+}
+
+/**
+Dequeue a pointer; must only be called from the consumer thread
+@param ring
+	A pointer to the ring
+@return
+	The dequeued pointer, or NULL if the ring is empty
+*/
+void *spsc_pop(SpscRing *ring) {
+	size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	if (head == atomic_load_explicit(&ring->tail, memory_order_acquire))
+		return NULL;
+	void *item = ring->slots[head & ring->mask];
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+	return item;
+}
+
+/**
+Enqueue a pointer, yielding the processor for as long as the ring is full
+@param ring
+	A pointer to the ring
+@param item
+	The pointer to be enqueued
+*/
+void spsc_push_wait(SpscRing *ring, void *item) {
+	while (!spsc_push(ring, item))
+		sched_yield();
+}
+
+/**
+Dequeue a pointer, yielding the processor for as long as the ring is empty
+@param ring
+	A pointer to the ring
+@return
+	The dequeued pointer
+*/
+void *spsc_pop_wait(SpscRing *ring) {
+	void *item;
+	while ((item = spsc_pop(ring)) == NULL)
+		sched_yield();
+	return item;
+}
+
+/**
+Free the memory held by a ring
+@param ring
+	A pointer to the ring to be freed
+*/
+void spsc_free(SpscRing *ring) {
+	free(ring->slots);
+	ring->slots = NULL;
+}
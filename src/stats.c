@@ -0,0 +1,163 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "stats.h"
+#include "io.h"
+#include "sketch.h"
+#include "histogram.h"
+#include "utils.h"
+
+
+// Chars of Stats written as they are, up to the sketch's levels; only the amounts each level
+// 	holds are written after them, so a checkpoint is a fraction of the sketch's 64 KiB
+#define FIXED_SIZE offsetof(Stats, quantiles.levels)
+
+
+// Layout of a checkpoint file, followed by the first FIXED_SIZE chars of its Stats, then
+// 	the amounts of each level of its sketch, in order
+typedef struct {
+	uint32 magic;
+	uint32 version;
+	StatsMark mark;
+} StatsCheckpoint;
+
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Prepare aggregates of no entries
+@param stats
+	A pointer to the aggregates to be initialized
+*/
+void stats_init(Stats *stats) {
+	memset(stats, 0, sizeof(Stats));
+	stats->min = (Currency) -1;
+	sketch_init(&stats->quantiles);
+}
+
+/**
+Account for an accepted entry in O(1), amortized for its quantiles
+@param stats
+	A pointer to the aggregates to be updated
+@param amount
+	The entry's extended amount, multiplier applied
+*/
+void stats_add(Stats *stats, Currency amount) {
+	stats->count++;
+	stats->sum += amount;
+	if (amount < stats->min)
+		stats->min = amount;
+	if (amount > stats->max)
+		stats->max = amount;
+	histogram_add(&stats->histogram, amount);
+	sketch_add(&stats->quantiles, amount);
+}
+
+/**
+Find the mean amount of the accepted entries
+@param stats
+	A pointer to the aggregates
+@return
+	The mean, truncated to a whole cent; 0 if no entries were accepted
+*/
+Currency stats_mean(const Stats *stats) {
+	return stats->count > 0 ? stats->sum / stats->count : 0;
+}
+
+/**
+Account for each complete, valid line of a journal, as it would be accepted by the REPL
+@param stats
+	A pointer to the aggregates to be updated
+@param data
+	The journal's chars, beginning at the start of a line
+@param len
+	The number of chars available
+@return
+	The number of chars making up the complete lines scanned
+*/
+size_t stats_scan(Stats *stats, const char *data, size_t len) {
+	const char *p = data, *end = data + len, *nl;
+	unsigned multiplier;
+	while (p < end && (nl = memchr(p, '\n', end - p)) != NULL) {
+		size_t line_len = nl - p;
+		if (line_len > 0 && p[line_len-1] == '\r')
+			line_len--;
+		// Overlong lines are invalid, as journal_parse finds them
+		if (line_len < MAX_BUFFER_SIZE) {
+			Currency amount = sscann_line_item(p, line_len, &multiplier);
+			if (multiplier != 0)
+				stats_add(stats, amount);
+		}
+		p = nl + 1;
+	}
+	return p - data;
+}
+
+/**
+Read aggregates from a checkpoint file
+@param stats
+	A pointer to where the aggregates are stored
+@param mark
+	A pointer to where the journal chars the aggregates cover are stored; the caller
+	checks that they still match the journal
+@param path
+	The path to the checkpoint file
+@return
+	Whether a valid checkpoint was read; if not, stats and mark are left unchanged
+*/
+bool stats_load(Stats *stats, StatsMark *mark, const char *path) {
+	StatsCheckpoint c;
+	Stats *loaded = malloc(sizeof(Stats));
+	FILE *file = fopen(path, "rb");
+	if (loaded == NULL) {
+		ERROR("Out of memory");
+	}
+	bool ok = file != NULL && fread(&c, sizeof(c), 1, file) == 1 && c.magic == STATS_MAGIC
+			&& c.version == STATS_VERSION && fread(loaded, FIXED_SIZE, 1, file) == 1;
+	for (size_t h = 0; ok && h < SKETCH_LEVELS; h++) {
+		size_t n = loaded->quantiles.sizes[h];
+		ok = n <= SKETCH_K && fread(loaded->quantiles.levels[h], sizeof(Currency), n, file) == n;
+	}
+	if (file != NULL)
+		fclose(file);
+	if (ok) {
+		*stats = *loaded;
+		*mark = c.mark;
+	}
+	free(loaded);
+	return ok;
+}
+
+/**
+Write aggregates to a checkpoint file, replacing any previous checkpoint at once
+@param stats
+	A pointer to the aggregates to be written
+@param mark
+	A pointer to the journal chars the aggregates cover
+@param path
+	The path to the checkpoint file
+@return
+	Whether the checkpoint was written
+*/
+bool stats_save(const Stats *stats, const StatsMark *mark, const char *path) {
+	StatsCheckpoint c = {STATS_MAGIC, STATS_VERSION, *mark};
+	char tmp[strlen(path) + 5];
+	snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+	FILE *file = fopen(tmp, "wb");
+	if (file == NULL)
+		return false;
+	bool ok = fwrite(&c, sizeof(c), 1, file) == 1 && fwrite(stats, FIXED_SIZE, 1, file) == 1;
+	for (size_t h = 0; ok && h < SKETCH_LEVELS; h++) {
+		size_t n = stats->quantiles.sizes[h];
+		ok = fwrite(stats->quantiles.levels[h], sizeof(Currency), n, file) == n;
+	}
+	ok = fclose(file) == 0 && ok;
+	if (ok)
+		ok = rename(tmp, path) == 0;
+	else
+		remove(tmp);
+	return ok;
+}
@@ -0,0 +1,206 @@
+#include "sum.h"
+#include "utils.h"
+
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define SUM_X86
+#endif
+
+// Any amount setting one of these bits could carry a block's total past 64 bits
+#define GUARD_MASK (~(Currency) 0 << (64 - SUM_GUARD_BITS))
+
+
+/******
+ * Static Functions (marked with s_ prefix)
+ ******/
+
+// Add a 64-bit value to a 128-bit total, carrying into its high word
+static inline void s_carry(Sum *sum, Currency amount) {
+	sum->high += __builtin_add_overflow(sum->low, amount, &sum->low);
+}
+
+// Sum a block amount by amount into the 128-bit total; exact, whatever the amounts
+static void s_block_wide(Sum *sum, const Currency *amounts, size_t n) {
+	for (size_t i = 0; i < n; i++)
+		s_carry(sum, amounts[i]);
+}
+
+// Each kernel sums at most SUM_BLOCK amounts into out, or returns false if any
+// 	amount sets a guard bit, in which case out may have wrapped
+static bool s_block_scalar(const Currency *amounts, size_t n, Currency *out) {
+	Currency total = 0, bits = 0;
+	for (size_t i = 0; i < n; i++) {
+		total += amounts[i];
+		bits |= amounts[i];
+	}
+	*out = total;
+	return (bits & GUARD_MASK) == 0;
+}
+
+#ifdef SUM_X86
+// Two lanes per register, in two registers so consecutive adds are independent
+static bool s_block_sse(const Currency *amounts, size_t n, Currency *out) {
+	__m128i a = _mm_setzero_si128(), b = _mm_setzero_si128(), bits = _mm_setzero_si128();
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i x = _mm_loadu_si128((const __m128i*) (amounts + i));
+		__m128i y = _mm_loadu_si128((const __m128i*) (amounts + i + 2));
+		a = _mm_add_epi64(a, x);
+		b = _mm_add_epi64(b, y);
+		bits = _mm_or_si128(bits, _mm_or_si128(x, y));
+	}
+	a = _mm_add_epi64(a, b);
+	a = _mm_add_epi64(a, _mm_unpackhi_epi64(a, a));
+	bits = _mm_or_si128(bits, _mm_unpackhi_epi64(bits, bits));
+	Currency tail;
+	bool ok = s_block_scalar(amounts + i, n - i, &tail);
+	*out = (Currency) _mm_cvtsi128_si64(a) + tail;
+	return ok && ((Currency) _mm_cvtsi128_si64(bits) & GUARD_MASK) == 0;
+}
+
+// Four lanes per register, in two registers
+__attribute__((target("avx2")))
+static bool s_block_avx2(const Currency *amounts, size_t n, Currency *out) {
+	__m256i a = _mm256_setzero_si256(), b = _mm256_setzero_si256(), bits = _mm256_setzero_si256();
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i x = _mm256_loadu_si256((const __m256i*) (amounts + i));
+		__m256i y = _mm256_loadu_si256((const __m256i*) (amounts + i + 4));
+		a = _mm256_add_epi64(a, x);
+		b = _mm256_add_epi64(b, y);
+		bits = _mm256_or_si256(bits, _mm256_or_si256(x, y));
+	}
+	a = _mm256_add_epi64(a, b);
+	__m128i half = _mm_add_epi64(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1));
+	half = _mm_add_epi64(half, _mm_unpackhi_epi64(half, half));
+	__m128i mask = _mm_or_si128(_mm256_castsi256_si128(bits), _mm256_extracti128_si256(bits, 1));
+	mask = _mm_or_si128(mask, _mm_unpackhi_epi64(mask, mask));
+	Currency tail;
+	bool ok = s_block_scalar(amounts + i, n - i, &tail);
+	*out = (Currency) _mm_cvtsi128_si64(half) + tail;
+	return ok && ((Currency) _mm_cvtsi128_si64(mask) & GUARD_MASK) == 0;
+}
+
+// Eight lanes per register, in two registers
+__attribute__((target("avx512f")))
+static bool s_block_avx512(const Currency *amounts, size_t n, Currency *out) {
+	__m512i a = _mm512_setzero_si512(), b = _mm512_setzero_si512(), bits = _mm512_setzero_si512();
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m512i x = _mm512_loadu_si512(amounts + i);
+		__m512i y = _mm512_loadu_si512(amounts + i + 8);
+		a = _mm512_add_epi64(a, x);
+		b = _mm512_add_epi64(b, y);
+		bits = _mm512_or_si512(bits, _mm512_or_si512(x, y));
+	}
+	Currency tail;
+	bool ok = s_block_scalar(amounts + i, n - i, &tail);
+	*out = (Currency) _mm512_reduce_add_epi64(_mm512_add_epi64(a, b)) + tail;
+	return ok && ((Currency) _mm512_reduce_or_epi64(bits) & GUARD_MASK) == 0;
+}
+#endif
+
+// Resolve SUM_AUTO, and any kernel the processor lacks, to the widest one it supports
+static SumKernel s_resolve(SumKernel kernel) {
+	if (kernel == SUM_AUTO)
+		kernel = SUM_AVX512;
+	while (kernel != SUM_SCALAR && !sum_supported(kernel))
+		kernel--;
+	return kernel;
+}
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Prepare an empty total
+@param sum
+	A pointer to the total to be initialized
+*/
+void sum_init(Sum *sum) {
+	sum->low = 0;
+	sum->high = 0;
+}
+
+/**
+Check whether the processor can run a summation kernel
+@param kernel
+	The kernel to be checked
+@return
+	True if sum_amounts would use the kernel as given
+*/
+bool sum_supported(SumKernel kernel) {
+	switch (kernel) {
+	case SUM_AUTO:
+	case SUM_SCALAR:
+		return true;
+#ifdef SUM_X86
+	case SUM_SSE:
+		return true;            // Part of every x86-64 processor
+	case SUM_AVX2:
+		return __builtin_cpu_supports("avx2");
+	case SUM_AVX512:
+		return __builtin_cpu_supports("avx512f");
+#endif
+	default:
+		return false;
+	}
+}
+
+/**
+Add an array of amounts to a total. Blocks of amounts are summed in 64-bit lanes; a
+	block holding an amount too large to rule out overflow is instead summed amount by
+	amount into the 128-bit total, so the result is exact either way
+@param sum
+	A pointer to the total
+@param amounts
+	The amounts to be added
+@param n
+	The number of amounts
+@param kernel
+	The kernel with which blocks are summed; one the processor lacks is narrowed to
+	the widest it supports
+*/
+void sum_amounts(Sum *sum, const Currency *amounts, size_t n, SumKernel kernel) {
+	bool (*block)(const Currency*, size_t, Currency*) = s_block_scalar;
+#ifdef SUM_X86
+	switch (s_resolve(kernel)) {
+	case SUM_SSE:
+		block = s_block_sse;
+		break;
+	case SUM_AVX2:
+		block = s_block_avx2;
+		break;
+	case SUM_AVX512:
+		block = s_block_avx512;
+		break;
+	default:
+		break;
+	}
+#else
+	(void) s_resolve(kernel);
+#endif
+	while (n > 0) {
+		size_t m = n < SUM_BLOCK ? n : SUM_BLOCK;
+		Currency total;
+		if (block(amounts, m, &total))
+			s_carry(sum, total);
+		else
+			s_block_wide(sum, amounts, m);
+		amounts += m;
+		n -= m;
+	}
+}
+
+/**
+Check whether a total fits within a Currency
+@param sum
+	A pointer to the total
+@return
+	True if the total's high word is clear, so its low word holds the whole total
+*/
+bool sum_fits(const Sum *sum) {
+	return sum->high == 0;
+}
@@ -0,0 +1,147 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "topk.h"
+#include "utils.h"
+
+
+/******
+ * Static Functions (marked with s_ prefix)
+ ******/
+
+// Whether entry a ranks below entry b: a smaller amount, or an equal amount on a later line
+static bool s_below(const TopEntry *a, const TopEntry *b) {
+	return a->amount < b->amount || (a->amount == b->amount && a->line > b->line);
+}
+
+// Restore the heap below the root after it was replaced
+static void s_sift_down(TopK *top) {
+	TopEntry *heap = top->heap, root = heap[0];
+	size_t i = 0, child;
+	while ((child = 2*i + 1) < top->count) {
+		if (child + 1 < top->count && s_below(&heap[child+1], &heap[child]))
+			child++;
+		if (!s_below(&heap[child], &root))
+			break;
+		heap[i] = heap[child];
+		i = child;
+	}
+	heap[i] = root;
+}
+
+// Raise the threshold to just above the smallest entry, once the heap is full
+static void s_update_threshold(TopK *top) {
+	if (top->count < top->k)
+		return;
+	Currency least = top->heap[0].amount;
+	top->threshold = least + (least != (Currency) -1);
+}
+
+// Place an entry that ranks above the smallest, or fills an empty slot
+static void s_insert(TopK *top, TopEntry entry) {
+	if (top->count < top->k) {
+		size_t i = top->count++, parent;
+		for (; i > 0 && s_below(&entry, &top->heap[parent = (i-1) / 2]); i = parent)
+			top->heap[i] = top->heap[parent];
+		top->heap[i] = entry;
+	}
+	else if (s_below(&top->heap[0], &entry)) {
+		top->heap[0] = entry;
+		s_sift_down(top);
+	}
+	s_update_threshold(top);
+}
+
+// Order entries largest first, then by line
+static int s_compare(const void *a, const void *b) {
+	return s_below(a, b) - s_below(b, a);
+}
+
+
+/******
+ * Public Functions
+ ******/
+
+/**
+Prepare to track the largest entries
+@param top
+	A pointer to the tracker to be initialized
+@param k
+	The number of entries to keep; clamped to TOPK_MAX
+*/
+void topk_init(TopK *top, size_t k) {
+	top->k = k < TOPK_MAX ? k : TOPK_MAX;
+	top->count = 0;
+	top->threshold = 0;
+}
+
+/**
+Offer an entry, as entries are streamed in line order. An entry below the k-th
+	largest costs one compare; ties with it are rejected, keeping the earlier line
+@param top
+	A pointer to the tracker
+@param amount
+	The entry's amount
+@param line
+	The entry's line number
+*/
+void topk_offer(TopK *top, Currency amount, uint64 line) {
+	if (amount < top->threshold || top->k == 0)
+		return;
+	s_insert(top, (TopEntry) {amount, line});
+}
+
+/**
+Offer a batch of entries on consecutive lines, as the pipeline and settle.bin scan them
+@param top
+	A pointer to the tracker
+@param amounts
+	The entries' amounts
+@param n
+	The number of entries
+@param first_line
+	The line number of the first entry
+*/
+void topk_offer_batch(TopK *top, const Currency *amounts, size_t n, uint64 first_line) {
+	if (top->k == 0)
+		return;
+	Currency threshold = top->threshold;
+	for (size_t i = 0; i < n; i++) {
+		if (__builtin_expect(amounts[i] < threshold, 1))
+			continue;
+		s_insert(top, (TopEntry) {amounts[i], first_line + i});
+		threshold = top->threshold;
+	}
+}
+
+/**
+Merge the entries kept by one tracker into another, as when combining per-thread trackers
+@param into
+	A pointer to the tracker receiving the entries
+@param from
+	A pointer to the tracker to be merged; it is left unchanged
+@param line_offset
+	An amount added to the line numbers of from, such as the lines preceding its part of a journal
+*/
+void topk_merge(TopK *into, const TopK *from, uint64 line_offset) {
+	for (size_t i = 0; i < from->count; i++) {
+		// Compared in full, as a tie may come from an earlier line
+		if (into->k > 0)
+			s_insert(into, (TopEntry) {from->heap[i].amount, from->heap[i].line + line_offset});
+	}
+}
+
+/**
+List the entries kept, largest first
+@param top
+	A pointer to the tracker
+@param out
+	A pointer to where the entries are stored; room for k entries is needed
+@return
+	The number of entries stored
+*/
+size_t topk_sorted(const TopK *top, TopEntry *out) {
+	memcpy(out, top->heap, top->count * sizeof(TopEntry));
+	qsort(out, top->count, sizeof(TopEntry), s_compare);
+	return top->count;
+}
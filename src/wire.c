@@ -0,0 +1,161 @@
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "wire.h"
+#include "utils.h"
+
+
+/******
+ * Static Functions (marked with s_ prefix)
+ ******/
+
+// Add an entry to a frame, unless the frame is full
+static bool s_add_entry(WireFrame *frame, uint8 kind, uint64 value, uint32 multiplier) {
+	if (frame->header.count >= WIRE_MAX_ENTRIES)
+		return false;
+	WireEntry *entry = &frame->entries[frame->header.count++];
+	memset(entry, 0, sizeof(WireEntry));
+	entry->kind = kind;
+	entry->value = value;
+	entry->multiplier = multiplier;
+	return true;
+}
+
+// Transfer exactly n bytes, retrying short reads and writes; false on error or EOF
+static bool s_transfer(int fd, void *buf, size_t n, bool writing) {
+	char *p = buf;
+	while (n > 0) {
+		ssize_t len = writing ? write(fd, p, n) : read(fd, p, n);
+		if (len < 0 && errno == EINTR)
+			continue;
+		if (len <= 0)
+			return false;
+		p += len;
+		n -= len;
+	}
+	return true;
+}
+
+
+/******
+ * Public Functions
+ ******/
+
+// ***** Framing
+
+/**
+Find the size of the frame a header begins
+@param header
+	A pointer to the frame's header
+@return
+	The number of bytes in the frame, header included
+*/
+size_t wire_frame_size(const WireHeader *header) {
+	return sizeof(WireHeader) + header->count * sizeof(WireEntry);
+}
+
+/**
+Check whether a header begins a frame this version of the protocol understands
+@param header
+	A pointer to the header to be checked
+@return
+	Whether the header is valid
+*/
+bool wire_header_valid(const WireHeader *header) {
+	return header->magic == WIRE_MAGIC && header->version == WIRE_VERSION
+		&& header->count <= WIRE_MAX_ENTRIES;
+}
+
+// ***** Client
+
+/**
+Connect to the daemon's socket
+@param path
+	The filesystem path of the daemon's socket
+@return
+	A connected file descriptor, or -1 on failure
+*/
+int wire_connect(const char *path) {
+	struct sockaddr_un addr = {.sun_family = AF_UNIX};
+	if (strlen(path) >= sizeof(addr.sun_path))
+		return -1;
+	strcpy(addr.sun_path, path);
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd >= 0 && connect(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/**
+Prepare an empty frame of entries for a register session
+@param frame
+	A pointer to the frame to be initialized
+@param session
+	The ID of the session the frame's entries apply to
+*/
+void wire_frame_init(WireFrame *frame, uint32 session) {
+	frame->header.magic = WIRE_MAGIC;
+	frame->header.version = WIRE_VERSION;
+	frame->header.count = 0;
+	frame->header.session = session;
+}
+
+/**
+Add an amount of currency to a frame
+@param frame
+	A pointer to the frame
+@param amount
+	The amount of currency per unit
+@param multiplier
+	The number of units
+@return
+	Whether the entry was added; false if the frame is full
+*/
+bool wire_add_currency(WireFrame *frame, Currency amount, uint32 multiplier) {
+	return s_add_entry(frame, WIRE_CURRENCY, amount, multiplier);
+}
+
+/**
+Add a percentage of the running total to a frame
+@param frame
+	A pointer to the frame
+@param percent
+	The percentage to be applied
+@return
+	Whether the entry was added; false if the frame is full
+*/
+bool wire_add_percent(WireFrame *frame, Percent percent) {
+	return s_add_entry(frame, WIRE_PERCENT, percent, 1);
+}
+
+/**
+Send a frame to the daemon, wait for its reply, then empty the frame for reuse
+@param fd
+	A file descriptor connected to the daemon
+@param frame
+	A pointer to the frame to be sent
+@param total
+	A pointer to where the session's total after the frame is stored; may be NULL
+@return
+	Whether the frame was sent and a valid reply received
+*/
+bool wire_submit(int fd, WireFrame *frame, Currency *total) {
+	struct {
+		WireHeader header;
+		WireEntry entry;
+	} reply;
+	if (!s_transfer(fd, frame, wire_frame_size(&frame->header), true))
+		return false;
+	frame->header.count = 0;
+	if (!s_transfer(fd, &reply, sizeof(reply), false) || !wire_header_valid(&reply.header)
+			|| reply.header.count != 1)
+		return false;
+	if (total != NULL)
+		*total = reply.entry.value;
+	return true;
+}
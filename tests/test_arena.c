@@ -0,0 +1,74 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "unity/unity.h"
+#include "arena.h"
+
+
+#define CHUNK_SIZE 256
+
+
+static Arena arena;
+
+
+// Run before each test
+void setUp(void) {
+	arena_init(&arena, CHUNK_SIZE);
+}
+
+// Run after each test
+void tearDown(void) {
+	arena_free(&arena);
+}
+
+void test_arena_alloc_returns_aligned_memory(void) {
+	size_t sizes[] = {1, 3, 16, 17, 100, 0};
+	for (size_t *n = sizes; *n != 0; n++) {
+		void *p = arena_alloc(&arena, *n);
+		TEST_ASSERT_NOT_NULL(p);
+		TEST_ASSERT_EQUAL_UINT(0, (uintptr_t) p % ARENA_ALIGN);
+	}
+}
+
+void test_arena_alloc_spans_chunks(void) {
+	char *first = arena_alloc(&arena, CHUNK_SIZE);
+	char *second = arena_alloc(&arena, CHUNK_SIZE);
+	memset(first, 'a', CHUNK_SIZE);
+	memset(second, 'b', CHUNK_SIZE);
+	TEST_ASSERT_EQUAL_CHAR('a', first[CHUNK_SIZE-1]);
+	TEST_ASSERT_NOT_NULL(arena.head->next);
+}
+
+void test_arena_alloc_handles_oversized_requests(void) {
+	char *big = arena_alloc(&arena, 4 * CHUNK_SIZE);
+	memset(big, 'c', 4 * CHUNK_SIZE);
+	TEST_ASSERT_EQUAL_CHAR('c', big[4*CHUNK_SIZE - 1]);
+}
+
+void test_arena_reset_reuses_chunks(void) {
+	void *first = arena_alloc(&arena, 64);
+	arena_alloc(&arena, CHUNK_SIZE);
+	ArenaChunk *head = arena.head, *second = arena.head->next;
+	arena_reset(&arena);
+	TEST_ASSERT_EQUAL_PTR(first, arena_alloc(&arena, 64));
+	arena_alloc(&arena, CHUNK_SIZE);
+	TEST_ASSERT_EQUAL_PTR(head, arena.head);
+	TEST_ASSERT_EQUAL_PTR(second, arena.head->next);
+	TEST_ASSERT_NULL(second->next);
+}
+
+void test_arena_strdup_copies_str(void) {
+	char *copy = arena_strdup(&arena, "$9.07x3");
+	TEST_ASSERT_EQUAL_STRING("$9.07x3", copy);
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_arena_alloc_returns_aligned_memory);
+	RUN_TEST(test_arena_alloc_spans_chunks);
+	RUN_TEST(test_arena_alloc_handles_oversized_requests);
+	RUN_TEST(test_arena_reset_reuses_chunks);
+	RUN_TEST(test_arena_strdup_copies_str);
+	return UNITY_END();
+}
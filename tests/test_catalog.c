@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "unity/unity.h"
+#include "catalog.h"
+
+
+#define SKUS 10000
+
+
+static Catalog catalog;
+static const char *text =
+	"012345678905 4.99 Milk, 1 gal\n"
+	"ABC-1\t0.25\n"
+	"\n"
+	"BREAD 3.50 Bread  \r\n"
+	"ABC-1 0.30 Gum\n";
+
+
+// Run before each test
+void setUp(void) {
+	TEST_ASSERT_TRUE(catalog_build(&catalog, text, strlen(text)));
+}
+
+// Run after each test
+void tearDown(void) {
+	catalog_free(&catalog);
+}
+
+void test_catalog_finds_each_sku(void) {
+	TEST_ASSERT_EQUAL_UINT(3, catalog.count);
+	const CatalogEntry *e = catalog_find(&catalog, "012345678905", 12);
+	TEST_ASSERT_NOT_NULL(e);
+	TEST_ASSERT_EQUAL_UINT(499, e->price);
+	TEST_ASSERT_EQUAL_STRING("Milk, 1 gal", catalog.names + e->name);
+	e = catalog_find(&catalog, "BREAD", 5);
+	TEST_ASSERT_NOT_NULL(e);
+	TEST_ASSERT_EQUAL_STRING("Bread", catalog.names + e->name);
+	TEST_ASSERT_NULL(catalog_find(&catalog, "BREA", 4));
+	TEST_ASSERT_NULL(catalog_find(&catalog, "012345678906", 12));
+	TEST_ASSERT_NULL(catalog_find(&catalog, "", 0));
+}
+
+void test_catalog_keeps_last_definition(void) {
+	const CatalogEntry *e = catalog_find(&catalog, "ABC-1", 5);
+	TEST_ASSERT_NOT_NULL(e);
+	TEST_ASSERT_EQUAL_UINT(30, e->price);
+	TEST_ASSERT_EQUAL_STRING("Gum", catalog.names + e->name);
+}
+
+void test_catalog_scan_applies_multiplier(void) {
+	const CatalogEntry *e;
+	unsigned multiplier;
+	TEST_ASSERT_EQUAL_UINT(499, catalog_scan(&catalog, " #012345678905", 14, &multiplier, &e));
+	TEST_ASSERT_EQUAL_UINT(1, multiplier);
+	TEST_ASSERT_EQUAL_UINT(120, catalog_scan(&catalog, "#ABC-1x4", 8, &multiplier, &e));
+	TEST_ASSERT_EQUAL_UINT(4, multiplier);
+	TEST_ASSERT_EQUAL_UINT(700, catalog_scan(&catalog, "#BREADX2", 8, &multiplier, NULL));
+	const char *invalid[] = {"#BREADx0", "#BREAD x2", "#x2", "BREAD", "#", "#NOPE", "4.99", NULL};
+	for (const char **in = invalid; *in != NULL; in++) {
+		TEST_ASSERT_EQUAL_UINT_MESSAGE(0, catalog_scan(&catalog, *in, strlen(*in), &multiplier, NULL), *in);
+		TEST_ASSERT_EQUAL_UINT_MESSAGE(0, multiplier, *in);
+	}
+}
+
+void test_catalog_rejects_invalid_lines(void) {
+	Catalog bad;
+	const char *invalid[] = {"ABC\n", "ABC 1.00x2\n", "ABC Hello\n", "AB/C 1.00\n", "ABCx12 1.00\n",
+			"01234567890123456789 1.00\n", NULL};
+	for (const char **in = invalid; *in != NULL; in++)
+		TEST_ASSERT_FALSE_MESSAGE(catalog_build(&bad, *in, strlen(*in)), *in);
+	TEST_ASSERT_TRUE(catalog_build(&bad, "", 0));
+	TEST_ASSERT_EQUAL_UINT(0, bad.count);
+	TEST_ASSERT_NULL(catalog_find(&bad, "ABC", 3));
+	catalog_free(&bad);
+}
+
+void test_catalog_keeps_last_of_many_definitions(void) {
+	Catalog redefined;
+	char *data = malloc(SKUS * 32);
+	size_t len = 0;
+	for (unsigned long i = 0; i < SKUS; i++)
+		len += sprintf(data + len, "%s %lu.%02lu\n", i % 2 ? "ODD" : "EVEN", i / 100, i % 100);
+	TEST_ASSERT_TRUE(catalog_build(&redefined, data, len));
+	TEST_ASSERT_EQUAL_UINT(2, redefined.count);
+	TEST_ASSERT_EQUAL_UINT(SKUS - 1, catalog_find(&redefined, "ODD", 3)->price);
+	TEST_ASSERT_EQUAL_UINT(SKUS - 2, catalog_find(&redefined, "EVEN", 4)->price);
+	catalog_free(&redefined);
+	free(data);
+}
+
+void test_catalog_hash_is_minimal_and_perfect(void) {
+	Catalog large;
+	char *data = malloc(SKUS * 32), sku[CATALOG_SKU_MAX + 1];
+	bool *used = calloc(SKUS, sizeof(bool));
+	size_t len = 0;
+	for (unsigned long i = 0; i < SKUS; i++)
+		len += sprintf(data + len, "SKU%lu %lu.%02lu\n", i * 7919, i / 100, i % 100);
+	TEST_ASSERT_TRUE(catalog_build(&large, data, len));
+	TEST_ASSERT_EQUAL_UINT(SKUS, large.count);
+	for (unsigned long i = 0; i < SKUS; i++) {
+		int n = sprintf(sku, "SKU%lu", i * 7919);
+		const CatalogEntry *e = catalog_find(&large, sku, n);
+		TEST_ASSERT_NOT_NULL(e);
+		TEST_ASSERT_EQUAL_UINT(i, e->price);
+		TEST_ASSERT_FALSE(used[e - large.entries]);
+		used[e - large.entries] = true;
+	}
+	catalog_free(&large);
+	free(used);
+	free(data);
+}
+
+void test_catalog_maps_compiled_image(void) {
+	Catalog mapped;
+	char path[] = "build/test_catalog.XXXXXX";
+	close(mkstemp(path));
+	TEST_ASSERT_TRUE(catalog_save(&catalog, path));
+	TEST_ASSERT_TRUE(catalog_map(&mapped, path));
+	TEST_ASSERT_NOT_NULL(mapped.image);
+	TEST_ASSERT_EQUAL_UINT(catalog.count, mapped.count);
+	const char *skus[] = {"012345678905", "ABC-1", "BREAD", NULL};
+	for (const char **sku = skus; *sku != NULL; sku++) {
+		const CatalogEntry *a = catalog_find(&catalog, *sku, strlen(*sku));
+		const CatalogEntry *b = catalog_find(&mapped, *sku, strlen(*sku));
+		TEST_ASSERT_NOT_NULL(b);
+		TEST_ASSERT_EQUAL_UINT(a->price, b->price);
+		TEST_ASSERT_EQUAL_STRING(catalog_name(&catalog, a), catalog_name(&mapped, b));
+	}
+	TEST_ASSERT_NULL(catalog_find(&mapped, "NOPE", 4));
+	catalog_free(&mapped);
+	remove(path);
+}
+
+void test_catalog_interns_names(void) {
+	Catalog built, mapped;
+	const char *data = "A 1.00 Soda\nB 2.00 Soda\nC 3.00\nD 4.00 Chips\n";
+	char path[] = "build/test_catalog.XXXXXX";
+	close(mkstemp(path));
+	TEST_ASSERT_TRUE(catalog_build(&built, data, strlen(data)));
+	TEST_ASSERT_TRUE(catalog_save(&built, path));
+	TEST_ASSERT_TRUE(catalog_map(&mapped, path));
+	TEST_ASSERT_EQUAL_UINT(sizeof("") + sizeof("Soda") + sizeof("Chips"), mapped.names_len);
+	TEST_ASSERT_EQUAL_UINT(catalog_find(&mapped, "A", 1)->name, catalog_find(&mapped, "B", 1)->name);
+	TEST_ASSERT_EQUAL_STRING("", catalog_name(&mapped, catalog_find(&mapped, "C", 1)));
+	catalog_free(&built);
+	catalog_free(&mapped);
+	remove(path);
+}
+
+void test_catalog_rejects_invalid_images(void) {
+	Catalog mapped;
+	char path[] = "build/test_catalog.XXXXXX";
+	close(mkstemp(path));
+	TEST_ASSERT_FALSE(catalog_map(&mapped, path));
+	TEST_ASSERT_TRUE(catalog_save(&catalog, path));
+	// Cut short, then with its magic number spoiled
+	FILE *file = fopen(path, "r+b");
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	TEST_ASSERT_EQUAL_INT(0, ftruncate(fileno(file), size - 1));
+	TEST_ASSERT_FALSE(catalog_map(&mapped, path));
+	fseek(file, 0, SEEK_SET);
+	fputc('X', file);
+	fclose(file);
+	TEST_ASSERT_FALSE(catalog_map(&mapped, path));
+	TEST_ASSERT_FALSE(catalog_map(&mapped, "build/no_such_catalog"));
+	remove(path);
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_catalog_finds_each_sku);
+	RUN_TEST(test_catalog_keeps_last_definition);
+	RUN_TEST(test_catalog_scan_applies_multiplier);
+	RUN_TEST(test_catalog_rejects_invalid_lines);
+	RUN_TEST(test_catalog_keeps_last_of_many_definitions);
+	RUN_TEST(test_catalog_hash_is_minimal_and_perfect);
+	RUN_TEST(test_catalog_maps_compiled_image);
+	RUN_TEST(test_catalog_interns_names);
+	RUN_TEST(test_catalog_rejects_invalid_images);
+	return UNITY_END();
+}
@@ -0,0 +1,139 @@
+#include <stdexcept>
+#include <string>
+
+#include "unity/unity.h"
+#include "currency.hpp"
+
+
+using namespace cashregister;
+using namespace cashregister::literals;
+
+
+// Literals are evaluated during compilation
+static_assert(Usd::scale == 100);
+static_assert(Jpy::scale == 1);
+static_assert(Bhd::scale == 1000);
+static_assert("$9.07x3"_usd == Usd::from_minor(2721));
+static_assert("$5.5x10"_usd == Usd::from_minor(5500));
+static_assert("1005000.37"_usd == Usd::from_minor(100500037));
+static_assert("\xC2\xA5" "1200x2"_jpy == Jpy::from_minor(2400));
+static_assert("BD1.005"_bhd == Bhd::from_minor(1005));
+static_assert("1.5"_bhd == Bhd::from_minor(1500));
+
+
+// Run before each test
+void setUp(void) {
+
+}
+
+// Run after each test
+void tearDown(void) {
+
+}
+
+void test_parse_matches_c_scanner(void) {
+	const char *inputs[] = {"$0", "0.01", "$5.3", "500.37", "$9.07x3", "1.10x4", "220x6", NULL};
+	for (const char **in = inputs; *in != NULL; in++) {
+		TEST_ASSERT_EQUAL_UINT(sscan_currency((char*) *in), Usd::parse(*in).minor());
+	}
+}
+
+void test_parse_rejects_invalid_strs(void) {
+	const char *inputs[] = {"", "Hello", "$5,000.37", "127.0.0.1", "9.071", "5x", "99999999999999999999", NULL};
+	for (const char **in = inputs; *in != NULL; in++) {
+		bool thrown = false;
+		try {
+			Usd::parse(*in);
+		}
+		catch (const std::invalid_argument &) {
+			thrown = true;
+		}
+		TEST_ASSERT_TRUE_MESSAGE(thrown, *in);
+	}
+}
+
+void test_zero_decimal_currency_rejects_fraction(void) {
+	bool thrown = false;
+	try {
+		Jpy::parse("100.5");
+	}
+	catch (const std::invalid_argument &) {
+		thrown = true;
+	}
+	TEST_ASSERT_TRUE(thrown);
+}
+
+void test_to_string_returns_formatted_str(void) {
+	TEST_ASSERT_EQUAL_STRING("$0.00", Usd::from_minor(0).to_string().c_str());
+	TEST_ASSERT_EQUAL_STRING("$5.30", Usd::from_minor(530).to_string().c_str());
+	TEST_ASSERT_EQUAL_STRING("$5,000.37", Usd::from_minor(500037).to_string().c_str());
+	TEST_ASSERT_EQUAL_STRING("$1,005,000.37", Usd::from_minor(100500037).to_string().c_str());
+	TEST_ASSERT_EQUAL_STRING("\xC2\xA5" "12,000", Jpy::from_minor(12000).to_string().c_str());
+	TEST_ASSERT_EQUAL_STRING("BD1.005", Bhd::from_minor(1005).to_string().c_str());
+}
+
+void test_format_to_writes_without_allocating(void) {
+	char buf[MAX_BUFFER_SIZE];
+	char *end = Usd::from_minor(123456789012).format_to(buf);
+	*end = '\0';
+	TEST_ASSERT_EQUAL_STRING("$1,234,567,890.12", buf);
+	end = Usd::from_minor((::Currency) -1).format_to(buf);
+	*end = '\0';
+	TEST_ASSERT_EQUAL_STRING("$184,467,440,737,095,516.15", buf);
+	end = Bhd::from_minor(1000007).format_to(buf);
+	*end = '\0';
+	TEST_ASSERT_EQUAL_STRING("BD1,000.007", buf);
+}
+
+#if __has_include(<fmt/format.h>)
+void test_fmt_formats_as_printed(void) {
+	TEST_ASSERT_EQUAL_STRING("$12.34", fmt::format("{}", "12.34"_usd).c_str());
+	TEST_ASSERT_EQUAL_STRING("total $1,005,000.37 and BD1.005",
+			fmt::format("total {} and {}", Usd::from_minor(100500037), "BD1.005"_bhd).c_str());
+	bool thrown = false;
+	try {
+		(void) fmt::format(fmt::runtime("{:>10}"), "12.34"_usd);
+	}
+	catch (const fmt::format_error &) {
+		thrown = true;
+	}
+	TEST_ASSERT_TRUE(thrown);
+}
+#endif
+
+#if !defined(__cpp_consteval)
+// Without consteval, a literal outside a constant expression is parsed when it is evaluated
+void test_malformed_literal_throws_at_runtime(void) {
+	bool thrown = false;
+	try {
+		(void) "9.071"_usd;
+	}
+	catch (const std::invalid_argument &) {
+		thrown = true;
+	}
+	TEST_ASSERT_TRUE(thrown);
+}
+#endif
+
+void test_percent_truncates(void) {
+	TEST_ASSERT_EQUAL_UINT(65, ("$6.50"_usd).percent(10).minor());
+	TEST_ASSERT_EQUAL_UINT(0, ("$0.09"_usd).percent(10).minor());
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_parse_matches_c_scanner);
+	RUN_TEST(test_parse_rejects_invalid_strs);
+	RUN_TEST(test_zero_decimal_currency_rejects_fraction);
+	RUN_TEST(test_to_string_returns_formatted_str);
+	RUN_TEST(test_format_to_writes_without_allocating);
+#if __has_include(<fmt/format.h>)
+	RUN_TEST(test_fmt_formats_as_printed);
+#endif
+#if !defined(__cpp_consteval)
+	RUN_TEST(test_malformed_literal_throws_at_runtime);
+#endif
+	RUN_TEST(test_percent_truncates);
+	return UNITY_END();
+}
@@ -0,0 +1,174 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "unity/unity.h"
+#include "daemon.h"
+#include "wire.h"
+
+
+static Daemon served;
+static int client;
+static pthread_t server;
+static atomic_bool stopping;
+
+
+// Serve the daemon's sessions until stopped
+static void *s_serve(void *arg) {
+	(void) arg;
+	while (!atomic_load(&stopping))
+		daemon_poll(&served, 10);
+	return NULL;
+}
+
+// Send len bytes to the daemon
+static void s_send(const void *data, size_t len) {
+	TEST_ASSERT_EQUAL_INT((ssize_t) len, write(client, data, len));
+}
+
+// Read exactly len bytes of the daemon's replies
+static void s_receive(void *data, size_t len) {
+	for (size_t got = 0; got < len; ) {
+		ssize_t n = read(client, (char*) data + got, len - got);
+		TEST_ASSERT_TRUE(n > 0);
+		got += n;
+	}
+}
+
+// Check that the daemon's next replies are exactly the expected text
+static void s_expect(const char *expected) {
+	char reply[256] = "";
+	s_receive(reply, strlen(expected));
+	TEST_ASSERT_EQUAL_STRING(expected, reply);
+}
+
+// Run before each test
+void setUp(void) {
+	int fds[2];
+	TEST_ASSERT_EQUAL_INT(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+	daemon_open(&served, NULL);
+	TEST_ASSERT_TRUE(daemon_add(&served, fds[0]));
+	client = fds[1];
+	atomic_store(&stopping, false);
+	pthread_create(&server, NULL, s_serve, NULL);
+}
+
+// Run after each test
+void tearDown(void) {
+	atomic_store(&stopping, true);
+	pthread_join(server, NULL);
+	close(client);
+	daemon_close(&served);
+}
+
+void test_daemon_replies_to_each_text_line(void) {
+	s_send("1.50\n2.25\r\n", 11);
+	s_expect("=> $1.50\n=> $3.75\n");
+	s_send("0.25\n", 5);
+	s_expect("=> $4.00\n");
+}
+
+void test_daemon_discards_overlong_line(void) {
+	char line[DAEMON_IN_SIZE + 100];
+	memset(line, '9', sizeof(line) - 1);
+	line[sizeof(line) - 1] = '\n';
+	s_send("1.00\n", 5);
+	s_expect("=> $1.00\n");
+	s_send(line, sizeof(line));
+	s_expect("=> $1.00\n");
+	s_send("2.00\n", 5);
+	s_expect("=> $3.00\n");
+}
+
+void test_daemon_applies_binary_frame(void) {
+	WireFrame frame;
+	struct {
+		WireHeader header;
+		WireEntry entry;
+	} reply;
+	wire_frame_init(&frame, 7);
+	TEST_ASSERT_TRUE(wire_add_currency(&frame, 250, 2));
+	TEST_ASSERT_TRUE(wire_add_percent(&frame, 10));
+	// Send the frame in two parts, so the daemon must wait for the rest of it
+	size_t size = wire_frame_size(&frame.header), half = size / 2;
+	s_send(&frame, half);
+	s_send((char*) &frame + half, size - half);
+	s_receive(&reply, sizeof(reply));
+	TEST_ASSERT_TRUE(wire_header_valid(&reply.header));
+	TEST_ASSERT_EQUAL_UINT(1, reply.header.count);
+	TEST_ASSERT_EQUAL_UINT(7, reply.header.session);
+	TEST_ASSERT_EQUAL_UINT(550, reply.entry.value);
+}
+
+void test_daemon_closes_session_breaking_protocol(void) {
+	WireFrame frame;
+	char byte;
+	wire_frame_init(&frame, 7);
+	frame.header.version = WIRE_VERSION + 1;
+	s_send(&frame, sizeof(WireHeader));
+	TEST_ASSERT_EQUAL_INT(0, read(client, &byte, 1));
+}
+
+void test_wire_submit_round_trip(void) {
+	WireFrame frame;
+	Currency total = 0;
+	wire_frame_init(&frame, 3);
+	TEST_ASSERT_TRUE(wire_add_currency(&frame, 199, 3));
+	TEST_ASSERT_TRUE(wire_submit(client, &frame, &total));
+	TEST_ASSERT_EQUAL_UINT(597, total);
+	TEST_ASSERT_EQUAL_UINT(0, frame.header.count);
+	// The register keeps its total across frames
+	TEST_ASSERT_TRUE(wire_add_currency(&frame, 3, 1));
+	TEST_ASSERT_TRUE(wire_add_percent(&frame, 50));
+	TEST_ASSERT_TRUE(wire_submit(client, &frame, &total));
+	TEST_ASSERT_EQUAL_UINT(900, total);
+	// An empty frame reads the total back unchanged
+	TEST_ASSERT_TRUE(wire_submit(client, &frame, NULL));
+	TEST_ASSERT_TRUE(wire_submit(client, &frame, &total));
+	TEST_ASSERT_EQUAL_UINT(900, total);
+}
+
+void test_daemons_keep_their_own_register_totals(void) {
+	Daemon other;
+	WireFrame frame;
+	struct {
+		WireHeader header;
+		WireEntry entry;
+	} reply;
+	Currency total;
+	int fds[2];
+	TEST_ASSERT_EQUAL_INT(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+	daemon_open(&other, NULL);
+	TEST_ASSERT_TRUE(daemon_add(&other, fds[0]));
+	wire_frame_init(&frame, 3);
+	TEST_ASSERT_TRUE(wire_add_currency(&frame, 100, 1));
+	TEST_ASSERT_TRUE(wire_submit(client, &frame, &total));
+	// The other daemon is served from this thread, once the frame has been sent
+	TEST_ASSERT_TRUE(wire_add_currency(&frame, 500, 1));
+	TEST_ASSERT_EQUAL_INT((ssize_t) wire_frame_size(&frame.header),
+			write(fds[1], &frame, wire_frame_size(&frame.header)));
+	TEST_ASSERT_EQUAL_INT(1, daemon_poll(&other, 1000));
+	TEST_ASSERT_EQUAL_INT(sizeof(reply), read(fds[1], &reply, sizeof(reply)));
+	TEST_ASSERT_EQUAL_UINT(500, reply.entry.value);
+	close(fds[1]);
+	daemon_close(&other);
+	// Closing the other daemon leaves this one's totals in place
+	frame.header.count = 0;
+	TEST_ASSERT_TRUE(wire_add_currency(&frame, 1, 1));
+	TEST_ASSERT_TRUE(wire_submit(client, &frame, &total));
+	TEST_ASSERT_EQUAL_UINT(101, total);
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_daemon_replies_to_each_text_line);
+	RUN_TEST(test_daemon_discards_overlong_line);
+	RUN_TEST(test_daemon_applies_binary_frame);
+	RUN_TEST(test_daemon_closes_session_breaking_protocol);
+	RUN_TEST(test_wire_submit_round_trip);
+	RUN_TEST(test_daemons_keep_their_own_register_totals);
+	return UNITY_END();
+}
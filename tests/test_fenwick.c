@@ -0,0 +1,66 @@
+#include "unity/unity.h"
+#include "fenwick.h"
+
+
+#define SIZE 1000
+
+
+static Fenwick fenwick;
+static Currency values[SIZE];
+
+
+// Sum the first n values directly, to check the tree against
+static Currency s_naive_prefix(size_t n) {
+	Currency sum = 0;
+	for (size_t i = 0; i < n; i++)
+		sum += values[i];
+	return sum;
+}
+
+// Run before each test
+void setUp(void) {
+	fenwick_init(&fenwick);
+	for (size_t i = 0; i < SIZE; i++) {
+		values[i] = (i * 7919) % 10007;
+		fenwick_append(&fenwick, values[i]);
+	}
+}
+
+// Run after each test
+void tearDown(void) {
+	fenwick_free(&fenwick);
+}
+
+void test_fenwick_prefix_matches_naive_sum(void) {
+	for (size_t n = 0; n <= SIZE; n++)
+		TEST_ASSERT_EQUAL_UINT(s_naive_prefix(n), fenwick_prefix(&fenwick, n));
+}
+
+void test_fenwick_prefix_clamps_to_count(void) {
+	TEST_ASSERT_EQUAL_UINT(s_naive_prefix(SIZE), fenwick_prefix(&fenwick, 2 * SIZE));
+}
+
+void test_fenwick_add_updates_later_prefixes(void) {
+	fenwick_add(&fenwick, 10, 500);
+	values[10] += 500;
+	fenwick_add(&fenwick, 600, -values[600]);
+	values[600] = 0;
+	for (size_t n = 0; n <= SIZE; n++)
+		TEST_ASSERT_EQUAL_UINT(s_naive_prefix(n), fenwick_prefix(&fenwick, n));
+}
+
+void test_fenwick_append_after_add(void) {
+	fenwick_add(&fenwick, 0, 1);
+	fenwick_append(&fenwick, 42);
+	TEST_ASSERT_EQUAL_UINT(s_naive_prefix(SIZE) + 43, fenwick_prefix(&fenwick, SIZE + 1));
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_fenwick_prefix_matches_naive_sum);
+	RUN_TEST(test_fenwick_prefix_clamps_to_count);
+	RUN_TEST(test_fenwick_add_updates_later_prefixes);
+	RUN_TEST(test_fenwick_append_after_add);
+	return UNITY_END();
+}
@@ -0,0 +1,77 @@
+#include "unity/unity.h"
+#include "histogram.h"
+
+
+#define AMOUNTS 10000
+
+
+static Histogram hist;
+
+
+// Run before each test
+void setUp(void) {
+	histogram_init(&hist);
+}
+
+// Run after each test
+void tearDown(void) {
+
+}
+
+void test_histogram_index_is_linear_for_small_amounts(void) {
+	for (Currency i = 0; i < 16; i++)
+		TEST_ASSERT_EQUAL_UINT(i, histogram_index(i));
+	TEST_ASSERT_EQUAL_UINT(16, histogram_index(16));
+	TEST_ASSERT_EQUAL_UINT(16, histogram_index(17));
+	TEST_ASSERT_EQUAL_UINT(17, histogram_index(18));
+	TEST_ASSERT_EQUAL_UINT(HISTOGRAM_BUCKETS - 1, histogram_index((Currency) -1));
+}
+
+void test_histogram_bounds_contain_their_amounts(void) {
+	Currency amounts[] = {0, 15, 16, 537, 2721, 100500037, 1UL << 40, (1UL << 40) - 1, (Currency) -1};
+	for (size_t i = 0; i < sizeof(amounts) / sizeof(amounts[0]); i++) {
+		size_t b = histogram_index(amounts[i]);
+		TEST_ASSERT_TRUE(histogram_floor(b) <= amounts[i]);
+		TEST_ASSERT_TRUE(histogram_ceiling(b) >= amounts[i]);
+		// No wider than an eighth of the lower bound
+		TEST_ASSERT_TRUE(histogram_ceiling(b) - histogram_floor(b) <= histogram_floor(b) / 8);
+	}
+	for (size_t b = 0; b + 1 < HISTOGRAM_BUCKETS; b++)
+		TEST_ASSERT_EQUAL_UINT(histogram_ceiling(b) + 1, histogram_floor(b + 1));
+}
+
+void test_histogram_add_batch_matches_single_adds(void) {
+	Currency amounts[AMOUNTS];
+	Histogram single;
+	histogram_init(&single);
+	for (size_t i = 0; i < AMOUNTS; i++) {
+		amounts[i] = (i * 2654435761UL) >> (i % 40);
+		histogram_add(&single, amounts[i]);
+	}
+	histogram_add_batch(&hist, amounts, AMOUNTS - 3);
+	histogram_add_batch(&hist, amounts + AMOUNTS - 3, 3);
+	TEST_ASSERT_EQUAL_UINT(AMOUNTS, hist.count);
+	TEST_ASSERT_EQUAL_MEMORY(&single, &hist, sizeof(Histogram));
+}
+
+void test_histogram_merge_adds_counts(void) {
+	Histogram other;
+	histogram_init(&other);
+	histogram_add(&hist, 537);
+	histogram_add(&other, 537);
+	histogram_add(&other, 99);
+	histogram_merge(&hist, &other);
+	TEST_ASSERT_EQUAL_UINT(3, hist.count);
+	TEST_ASSERT_EQUAL_UINT(2, hist.buckets[histogram_index(537)]);
+	TEST_ASSERT_EQUAL_UINT(1, hist.buckets[histogram_index(99)]);
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_histogram_index_is_linear_for_small_amounts);
+	RUN_TEST(test_histogram_bounds_contain_their_amounts);
+	RUN_TEST(test_histogram_add_batch_matches_single_adds);
+	RUN_TEST(test_histogram_merge_adds_counts);
+	return UNITY_END();
+}
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "unity/unity.h"
+#include "ingest.h"
+
+
+#define BUFFERS      6
+#define BUFFER_SIZE  4096
+#define FILE_SIZE    (10 * BUFFER_SIZE + 123)
+
+
+static FILE *file;
+static char *buffers[BUFFERS];
+static char expected[FILE_SIZE];
+
+
+// Run before each test
+void setUp(void) {
+	file = tmpfile();
+	TEST_ASSERT_NOT_NULL(file);
+	for (size_t i = 0; i < FILE_SIZE; i++)
+		expected[i] = 'a' + (i * 31) % 26;
+	fwrite(expected, 1, FILE_SIZE, file);
+	fflush(file);
+	rewind(file);
+	for (int i = 0; i < BUFFERS; i++)
+		buffers[i] = aligned_alloc(BUFFER_SIZE, BUFFER_SIZE);
+}
+
+// Run after each test
+void tearDown(void) {
+	fclose(file);
+	for (int i = 0; i < BUFFERS; i++)
+		free(buffers[i]);
+}
+
+// Read the whole file through a reader, keeping as many reads in flight as it allows
+static void s_read_all(int fd, IngestMode mode) {
+	static char got[FILE_SIZE];
+	Ingest in;
+	ssize_t n;
+	size_t total = 0;
+	int next = 0, i;
+	TEST_ASSERT_TRUE(ingest_init(&in, fd, mode, buffers, BUFFERS, BUFFER_SIZE));
+	while (ingest_submit(&in, next, buffers[next], BUFFER_SIZE))
+		next = (next + 1) % BUFFERS;
+	while ((i = ingest_wait(&in, &n)) >= 0) {
+		TEST_ASSERT_TRUE(n >= 0);
+		if (n == 0)
+			continue;
+		TEST_ASSERT_TRUE(total + n <= FILE_SIZE);
+		memcpy(got + total, buffers[i], n);
+		total += n;
+		if (n == BUFFER_SIZE) {
+			TEST_ASSERT_TRUE(ingest_submit(&in, next, buffers[next], BUFFER_SIZE));
+			next = (next + 1) % BUFFERS;
+		}
+	}
+	ingest_close(&in);
+	TEST_ASSERT_EQUAL_UINT(FILE_SIZE, total);
+	TEST_ASSERT_EQUAL_MEMORY(expected, got, FILE_SIZE);
+}
+
+void test_ingest_pread_returns_file_in_order(void) {
+	s_read_all(fileno(file), INGEST_PREAD);
+}
+
+void test_ingest_auto_returns_file_in_order(void) {
+	s_read_all(fileno(file), INGEST_AUTO);
+}
+
+void test_ingest_starts_at_file_position(void) {
+	Ingest in;
+	ssize_t n;
+	lseek(fileno(file), FILE_SIZE - 10, SEEK_SET);
+	TEST_ASSERT_TRUE(ingest_init(&in, fileno(file), INGEST_AUTO, buffers, BUFFERS, BUFFER_SIZE));
+	ingest_submit(&in, 0, buffers[0], BUFFER_SIZE);
+	TEST_ASSERT_EQUAL_INT(0, ingest_wait(&in, &n));
+	TEST_ASSERT_EQUAL_INT(10, n);
+	TEST_ASSERT_EQUAL_MEMORY(expected + FILE_SIZE - 10, buffers[0], 10);
+	ingest_close(&in);
+}
+
+void test_ingest_reads_pipes_in_order(void) {
+	int fds[2];
+	TEST_ASSERT_EQUAL_INT(0, pipe(fds));
+	if (fork() == 0) {
+		close(fds[0]);
+		// Written in uneven pieces, so reads of the pipe come back short
+		for (size_t i = 0; i < FILE_SIZE; i += 1000)
+			write(fds[1], expected + i, FILE_SIZE - i < 1000 ? FILE_SIZE - i : 1000);
+		_exit(0);
+	}
+	close(fds[1]);
+	s_read_all(fds[0], INGEST_AUTO);
+	close(fds[0]);
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_ingest_pread_returns_file_in_order);
+	RUN_TEST(test_ingest_auto_returns_file_in_order);
+	RUN_TEST(test_ingest_starts_at_file_position);
+	RUN_TEST(test_ingest_reads_pipes_in_order);
+	return UNITY_END();
+}
@@ -173,6 +173,32 @@ void test_sscan_currency_handles_invalid_strs(void) {
 	}
 }
 
+void test_sscan_line_item_returns_multiplier(void) {
+	unsigned multiplier;
+	TEST_ASSERT_EQUAL_UINT(2721, sscan_line_item("$9.07x3", &multiplier));
+	TEST_ASSERT_EQUAL_UINT(3, multiplier);
+	TEST_ASSERT_EQUAL_UINT(537, sscan_line_item("5.37", &multiplier));
+	TEST_ASSERT_EQUAL_UINT(1, multiplier);
+	TEST_ASSERT_EQUAL_UINT(INV_CURR, sscan_line_item("5x3y", &multiplier));
+	TEST_ASSERT_EQUAL_UINT(0, multiplier);
+}
+
+void test_sscann_line_item_stops_at_len(void) {
+	const TestDatum *datum;
+	unsigned multiplier;
+	char line[MAX_BUFFER_SIZE];
+	for (datum = VALID_CURR_INPS; datum->string != NULL; datum++) {
+		// Trailing chars past len must be ignored
+		snprintf(line, MAX_BUFFER_SIZE, "%s\nZZZ", datum->string);
+		TEST_ASSERT_EQUAL_UINT(datum->value, sscann_line_item(line, strlen(datum->string), &multiplier));
+	}
+	for (datum = INVALID_CURR_INPS; datum->string != NULL; datum++) {
+		TEST_ASSERT_EQUAL_UINT(INV_CURR, sscann_line_item(datum->string, strlen(datum->string), &multiplier));
+		TEST_ASSERT_EQUAL_UINT(0, multiplier);
+	}
+	TEST_ASSERT_EQUAL_UINT(INV_CURR, sscann_line_item("$", 1, &multiplier));
+}
+
 void test_fscan_currency_returns_correct_value(void) {
 	const TestDatum *datum;
 	Currency returned;
@@ -240,6 +266,8 @@ int main(void) {
 	RUN_TEST(test_sprint_currency_returns_formatted_str);
 	RUN_TEST(test_sscan_currency_returns_correct_value);
 	RUN_TEST(test_sscan_currency_handles_invalid_strs);
+	RUN_TEST(test_sscan_line_item_returns_multiplier);
+	RUN_TEST(test_sscann_line_item_stops_at_len);
 	RUN_TEST(test_fscan_currency_returns_correct_value);
 	// Percent IO Tests
 	RUN_TEST(test_sprint_percent_returns_formatted_str);
@@ -0,0 +1,95 @@
+#include "unity/unity.h"
+#include "items.h"
+
+
+static ItemStore store;
+
+
+// Run before each test
+void setUp(void) {
+	items_init(&store);
+}
+
+// Run after each test
+void tearDown(void) {
+	items_free(&store);
+}
+
+void test_items_push_returns_index(void) {
+	TEST_ASSERT_EQUAL_UINT(0, items_push(&store, 537, 1, ITEM_SALE));
+	TEST_ASSERT_EQUAL_UINT(1, items_push(&store, 2721, 3, ITEM_SALE));
+	TEST_ASSERT_EQUAL_UINT(2, store.count);
+	TEST_ASSERT_EQUAL_UINT(2721, store.amounts[1]);
+	TEST_ASSERT_EQUAL_UINT(3, store.multipliers[1]);
+	TEST_ASSERT_EQUAL_UINT(ITEM_SALE, store.types[1]);
+}
+
+void test_items_push_grows_geometrically(void) {
+	size_t capacity = 0, resizes = 0;
+	for (size_t i = 0; i < 100000; i++) {
+		items_push(&store, i, 1, ITEM_SALE);
+		if (store.capacity != capacity) {
+			capacity = store.capacity;
+			resizes++;
+		}
+	}
+	TEST_ASSERT_EQUAL_UINT(100000, store.count);
+	TEST_ASSERT_LESS_THAN_UINT(20, resizes);
+	TEST_ASSERT_EQUAL_UINT(99999, store.amounts[99999]);
+}
+
+void test_items_subtotal_skips_voids(void) {
+	items_push(&store, 100, 1, ITEM_SALE);
+	items_push(&store, 200, 1, ITEM_SALE);
+	items_push(&store, 400, 2, ITEM_SALE);
+	items_void(&store, 1);
+	TEST_ASSERT_EQUAL_UINT(500, items_subtotal(&store, 3));
+	TEST_ASSERT_EQUAL_UINT(100, items_subtotal(&store, 2));
+	TEST_ASSERT_EQUAL_UINT(500, items_subtotal(&store, 10));
+}
+
+void test_items_void_rejects_void_items(void) {
+	items_push(&store, 100, 1, ITEM_SALE);
+	TEST_ASSERT_TRUE(items_void(&store, 0));
+	TEST_ASSERT_FALSE(items_void(&store, 0));
+	TEST_ASSERT_FALSE(items_void(&store, 1));
+	TEST_ASSERT_EQUAL_UINT(0, items_subtotal(&store, 1));
+}
+
+void test_items_edit_updates_subtotals(void) {
+	items_push(&store, 100, 1, ITEM_SALE);
+	items_push(&store, 200, 1, ITEM_SALE);
+	items_push(&store, 400, 2, ITEM_SALE);
+	TEST_ASSERT_TRUE(items_edit(&store, 1, 50, 1));
+	TEST_ASSERT_EQUAL_UINT(150, items_subtotal(&store, 2));
+	TEST_ASSERT_EQUAL_UINT(550, items_subtotal(&store, 3));
+	TEST_ASSERT_TRUE(items_edit(&store, 0, 900, 3));
+	TEST_ASSERT_EQUAL_UINT(1350, items_subtotal(&store, 3));
+	TEST_ASSERT_EQUAL_UINT(3, store.multipliers[0]);
+	items_void(&store, 2);
+	TEST_ASSERT_FALSE(items_edit(&store, 2, 1, 1));
+}
+
+void test_items_tally_counts_by_type(void) {
+	Currency sum;
+	items_push(&store, 100, 1, ITEM_SALE);
+	items_push(&store, 200, 1, ITEM_SALE);
+	items_push(&store, 400, 2, ITEM_SALE);
+	items_void(&store, 0);
+	TEST_ASSERT_EQUAL_UINT(2, items_tally(&store, ITEM_SALE, &sum));
+	TEST_ASSERT_EQUAL_UINT(600, sum);
+	TEST_ASSERT_EQUAL_UINT(1, items_tally(&store, ITEM_VOID, &sum));
+	TEST_ASSERT_EQUAL_UINT(100, sum);
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_items_push_returns_index);
+	RUN_TEST(test_items_push_grows_geometrically);
+	RUN_TEST(test_items_subtotal_skips_voids);
+	RUN_TEST(test_items_void_rejects_void_items);
+	RUN_TEST(test_items_edit_updates_subtotals);
+	RUN_TEST(test_items_tally_counts_by_type);
+	return UNITY_END();
+}
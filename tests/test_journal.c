@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "unity/unity.h"
+#include "journal.h"
+#include "io.h"
+
+
+#define MAX_LINES 16
+
+
+static Currency amounts[MAX_LINES];
+
+
+// Run before each test
+void setUp(void) {
+	memset(amounts, 0, sizeof(amounts));
+}
+
+// Run after each test
+void tearDown(void) {
+
+}
+
+void test_journal_parse_scans_each_line(void) {
+	const char *data = "$5.37\n9.07x3\r\nHello\n\n1005000.37\n";
+	size_t consumed;
+	TEST_ASSERT_EQUAL_UINT(5, journal_parse(data, strlen(data), false, amounts, MAX_LINES, &consumed));
+	TEST_ASSERT_EQUAL_UINT(strlen(data), consumed);
+	TEST_ASSERT_EQUAL_UINT(537, amounts[0]);
+	TEST_ASSERT_EQUAL_UINT(2721, amounts[1]);
+	TEST_ASSERT_EQUAL_UINT(0, amounts[2]);
+	TEST_ASSERT_EQUAL_UINT(0, amounts[3]);
+	TEST_ASSERT_EQUAL_UINT(100500037, amounts[4]);
+}
+
+void test_journal_parse_leaves_partial_line(void) {
+	const char *data = "1\n2\n3";
+	size_t consumed;
+	TEST_ASSERT_EQUAL_UINT(2, journal_parse(data, strlen(data), false, amounts, MAX_LINES, &consumed));
+	TEST_ASSERT_EQUAL_UINT(4, consumed);
+	TEST_ASSERT_EQUAL_UINT(3, journal_parse(data, strlen(data), true, amounts, MAX_LINES, &consumed));
+	TEST_ASSERT_EQUAL_UINT(5, consumed);
+	TEST_ASSERT_EQUAL_UINT(300, amounts[2]);
+}
+
+void test_journal_parse_rejects_overlong_line(void) {
+	char data[2 * MAX_BUFFER_SIZE + 2];
+	size_t consumed;
+	// Each line is padded with leading spaces, the first to one char short of overlong
+	memset(data, ' ', sizeof(data));
+	memcpy(data + MAX_BUFFER_SIZE - 5, "1.00\n", 5);
+	memcpy(data + 2 * MAX_BUFFER_SIZE - 3, "1.00\n", 5);
+	TEST_ASSERT_EQUAL_UINT(2, journal_parse(data, sizeof(data), false, amounts, MAX_LINES, &consumed));
+	TEST_ASSERT_EQUAL_UINT(sizeof(data), consumed);
+	TEST_ASSERT_EQUAL_UINT(100, amounts[0]);
+	TEST_ASSERT_EQUAL_UINT(0, amounts[1]);
+}
+
+void test_journal_parse_stops_at_max(void) {
+	const char *data = "1\n2\n3\n";
+	size_t consumed;
+	TEST_ASSERT_EQUAL_UINT(2, journal_parse(data, strlen(data), true, amounts, 2, &consumed));
+	TEST_ASSERT_EQUAL_UINT(4, consumed);
+}
+
+void test_journal_total_mapped_matches_line_sum(void) {
+	FILE *journal = tmpfile();
+	JournalTotal result;
+	Currency expected = 0;
+	// Past JOURNAL_RELEASE_SIZE, so pages are released while scanning
+	unsigned long lines = 2 * JOURNAL_RELEASE_SIZE / 8;
+	for (unsigned long i = 0; i < lines; i++) {
+		fprintf(journal, "%lu.%02lu\n", i % 1000, i % 100);
+		expected += i % 1000 * 100 + i % 100;
+	}
+	fputs("Hello\r\n9.07x3", journal);
+	expected += 2721;
+	fflush(journal);
+	TEST_ASSERT_TRUE(journal_total_mapped(fileno(journal), &result, NULL));
+	TEST_ASSERT_EQUAL_UINT(expected, result.total);
+	TEST_ASSERT_EQUAL_UINT(lines + 2, result.lines);
+	fclose(journal);
+}
+
+void test_journal_total_mapped_handles_empty_and_unmappable(void) {
+	FILE *journal = tmpfile();
+	JournalTotal result;
+	int fds[2];
+	TEST_ASSERT_TRUE(journal_total_mapped(fileno(journal), &result, NULL));
+	TEST_ASSERT_EQUAL_UINT(0, result.lines);
+	fclose(journal);
+	TEST_ASSERT_EQUAL_INT(0, pipe(fds));
+	TEST_ASSERT_FALSE(journal_total_mapped(fds[0], &result, NULL));
+	close(fds[0]);
+	close(fds[1]);
+}
+
+void test_journal_fingerprint_tells_rewrites_from_appends(void) {
+	FILE *journal = tmpfile();
+	const char *data = "5.37\n9.07x3\n";
+	uint64 print, appended;
+	fputs(data, journal);
+	fflush(journal);
+	TEST_ASSERT_TRUE(journal_fingerprint_fd(fileno(journal), strlen(data), &print));
+	TEST_ASSERT_EQUAL_UINT64(journal_fingerprint(data, strlen(data), strlen(data)), print);
+	fputs("1.00\n", journal);
+	fflush(journal);
+	TEST_ASSERT_TRUE(journal_fingerprint_fd(fileno(journal), strlen(data), &appended));
+	TEST_ASSERT_EQUAL_UINT64(print, appended);
+	TEST_ASSERT_NOT_EQUAL(print, journal_fingerprint("5.37\n9.07x4\n", strlen(data), strlen(data)));
+	TEST_ASSERT_NOT_EQUAL(print, journal_fingerprint(data, strlen(data), strlen(data) + 1));
+	TEST_ASSERT_FALSE(journal_fingerprint_fd(fileno(journal), 1000, &print));
+	fclose(journal);
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_journal_parse_scans_each_line);
+	RUN_TEST(test_journal_parse_leaves_partial_line);
+	RUN_TEST(test_journal_parse_rejects_overlong_line);
+	RUN_TEST(test_journal_parse_stops_at_max);
+	RUN_TEST(test_journal_total_mapped_matches_line_sum);
+	RUN_TEST(test_journal_total_mapped_handles_empty_and_unmappable);
+	RUN_TEST(test_journal_fingerprint_tells_rewrites_from_appends);
+	return UNITY_END();
+}
@@ -0,0 +1,137 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "unity/unity.h"
+#include "live.h"
+
+
+#define READERS   3
+#define VERSIONS  200
+
+
+static LiveCatalog live;
+static char path[] = "build/test_live.XXXXXX";
+static atomic_bool stopping;
+
+
+// Replace the catalog file's contents
+static void s_write(const char *text) {
+	FILE *file = fopen(path, "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fputs(text, file);
+	fclose(file);
+}
+
+// Build catalog version v, in which A costs v and B costs twice as much
+static Catalog *s_version(unsigned long v) {
+	char text[64];
+	Catalog *cat = malloc(sizeof(Catalog));
+	int len = sprintf(text, "A %lu.00\nB %lu.00\n", v, 2 * v);
+	TEST_ASSERT_TRUE(catalog_build(cat, text, len));
+	return cat;
+}
+
+// Look both products up in whichever catalog is current until stopped, counting lookups
+// 	that saw prices from two versions at once
+static void *s_read(void *arg) {
+	LiveReader *reader = live_register(&live);
+	unsigned long *torn = arg;
+	while (!atomic_load(&stopping)) {
+		const Catalog *cat = live_enter(&live, reader);
+		Currency a = catalog_find(cat, "A", 1)->price, b = catalog_find(cat, "B", 1)->price;
+		live_exit(reader);
+		*torn += b != 2 * a;
+	}
+	return NULL;
+}
+
+// Run before each test
+void setUp(void) {
+	close(mkstemp(path));
+	s_write("A 1.00 Apple\nB 2.00\n");
+	TEST_ASSERT_TRUE(live_init(&live, path));
+}
+
+// Run after each test
+void tearDown(void) {
+	live_free(&live);
+	remove(path);
+	strcpy(path, "build/test_live.XXXXXX");
+}
+
+void test_live_reload_publishes_new_prices(void) {
+	LiveReader *reader = live_register(&live);
+	TEST_ASSERT_NOT_NULL(reader);
+	TEST_ASSERT_EQUAL_UINT(100, catalog_find(live_enter(&live, reader), "A", 1)->price);
+	live_exit(reader);
+	s_write("A 1.50 Apple\nC 3.00\n");
+	TEST_ASSERT_TRUE(live_reload(&live, path));
+	const Catalog *cat = live_enter(&live, reader);
+	TEST_ASSERT_EQUAL_UINT(150, catalog_find(cat, "A", 1)->price);
+	TEST_ASSERT_NULL(catalog_find(cat, "B", 1));
+	TEST_ASSERT_NOT_NULL(catalog_find(cat, "C", 1));
+	live_exit(reader);
+	TEST_ASSERT_EQUAL_UINT(0, live_reclaim(&live));
+}
+
+void test_live_keeps_catalog_on_failed_reload(void) {
+	LiveReader *reader = live_register(&live);
+	s_write("A one\n");
+	TEST_ASSERT_FALSE(live_reload(&live, path));
+	TEST_ASSERT_FALSE(live_reload(&live, "build/no_such_catalog"));
+	TEST_ASSERT_EQUAL_UINT(100, catalog_find(live_enter(&live, reader), "A", 1)->price);
+	live_exit(reader);
+}
+
+void test_live_holds_replaced_catalog_until_read(void) {
+	LiveReader *reader = live_register(&live), *other = live_register(&live);
+	const Catalog *old = live_enter(&live, reader);
+	live_publish(&live, s_version(5));
+	TEST_ASSERT_EQUAL_UINT(500, catalog_find(live_enter(&live, other), "A", 1)->price);
+	live_exit(other);
+	TEST_ASSERT_EQUAL_UINT(1, live_reclaim(&live));
+	TEST_ASSERT_EQUAL_UINT(100, catalog_find(old, "A", 1)->price);
+	TEST_ASSERT_EQUAL_STRING("Apple", catalog_name(old, catalog_find(old, "A", 1)));
+	live_exit(reader);
+	TEST_ASSERT_EQUAL_UINT(0, live_reclaim(&live));
+}
+
+void test_live_register_limits_readers(void) {
+	for (size_t i = 0; i < LIVE_MAX_READERS; i++)
+		TEST_ASSERT_NOT_NULL(live_register(&live));
+	TEST_ASSERT_NULL(live_register(&live));
+}
+
+void test_live_readers_see_whole_versions(void) {
+	pthread_t threads[READERS];
+	unsigned long torn[READERS] = {0};
+	atomic_store(&stopping, false);
+	for (size_t i = 0; i < READERS; i++)
+		pthread_create(&threads[i], NULL, s_read, &torn[i]);
+	for (unsigned long v = 2; v <= VERSIONS; v++) {
+		live_publish(&live, s_version(v));
+		sched_yield();
+	}
+	atomic_store(&stopping, true);
+	for (size_t i = 0; i < READERS; i++) {
+		pthread_join(threads[i], NULL);
+		TEST_ASSERT_EQUAL_UINT(0, torn[i]);
+	}
+	TEST_ASSERT_EQUAL_UINT(0, live_reclaim(&live));
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_live_reload_publishes_new_prices);
+	RUN_TEST(test_live_keeps_catalog_on_failed_reload);
+	RUN_TEST(test_live_holds_replaced_catalog_until_read);
+	RUN_TEST(test_live_register_limits_readers);
+	RUN_TEST(test_live_readers_see_whole_versions);
+	return UNITY_END();
+}
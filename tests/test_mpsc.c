@@ -0,0 +1,118 @@
+#include <pthread.h>
+#include <sched.h>
+
+#include "unity/unity.h"
+#include "mpsc.h"
+
+
+#define CAPACITY    64
+#define PRODUCERS    4
+#define PER_PRODUCER 20000
+
+
+static MpscRing ring;
+
+
+// Push the amounts 1 through PER_PRODUCER, retrying while the ring is full
+static void *s_produce(void *arg) {
+	for (Currency i = 1; i <= PER_PRODUCER; i++) {
+		while (!mpsc_push(&ring, i))
+			sched_yield();
+	}
+	return NULL;
+}
+
+// Push as s_produce does, yielding whenever the ring looks backed up, and record the
+// 	largest size seen
+static void *s_produce_watching(void *arg) {
+	size_t *largest = arg;
+	for (Currency i = 1; i <= PER_PRODUCER; i++) {
+		size_t size;
+		while ((size = mpsc_size(&ring)) >= CAPACITY / 2 || !mpsc_push(&ring, i)) {
+			if (size > *largest)
+				*largest = size;
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+// Run before each test
+void setUp(void) {
+	TEST_ASSERT_TRUE(mpsc_init(&ring, CAPACITY));
+}
+
+// Run after each test
+void tearDown(void) {
+	mpsc_free(&ring);
+}
+
+void test_mpsc_init_rejects_invalid_capacity(void) {
+	MpscRing bad;
+	TEST_ASSERT_FALSE(mpsc_init(&bad, 0));
+	TEST_ASSERT_FALSE(mpsc_init(&bad, 100));
+}
+
+void test_mpsc_pop_batch_preserves_order(void) {
+	Currency out[CAPACITY];
+	for (Currency i = 0; i < 10; i++)
+		TEST_ASSERT_TRUE(mpsc_push(&ring, i));
+	TEST_ASSERT_EQUAL_UINT(10, mpsc_size(&ring));
+	TEST_ASSERT_EQUAL_UINT(4, mpsc_pop_batch(&ring, out, 4));
+	TEST_ASSERT_EQUAL_UINT(6, mpsc_pop_batch(&ring, out + 4, CAPACITY));
+	for (Currency i = 0; i < 10; i++)
+		TEST_ASSERT_EQUAL_UINT(i, out[i]);
+	TEST_ASSERT_EQUAL_UINT(0, mpsc_pop_batch(&ring, out, CAPACITY));
+}
+
+void test_mpsc_push_reports_full_ring(void) {
+	Currency out[CAPACITY];
+	for (int i = 0; i < CAPACITY; i++)
+		TEST_ASSERT_TRUE(mpsc_push(&ring, i));
+	TEST_ASSERT_FALSE(mpsc_push(&ring, 0));
+	TEST_ASSERT_EQUAL_UINT(1, atomic_load(&ring.rejected));
+	// Consuming one entry frees one slot, even across laps of the ring
+	for (int lap = 0; lap < 3 * CAPACITY; lap++) {
+		TEST_ASSERT_EQUAL_UINT(1, mpsc_pop_batch(&ring, out, 1));
+		TEST_ASSERT_TRUE(mpsc_push(&ring, lap));
+	}
+}
+
+void test_mpsc_aggregator_totals_all_producers(void) {
+	MpscAggregator agg;
+	pthread_t producers[PRODUCERS];
+	TEST_ASSERT_TRUE(mpsc_aggregator_start(&agg, &ring));
+	for (int i = 0; i < PRODUCERS; i++)
+		pthread_create(&producers[i], NULL, s_produce, NULL);
+	for (int i = 0; i < PRODUCERS; i++)
+		pthread_join(producers[i], NULL);
+	Currency expected = PRODUCERS * (Currency) PER_PRODUCER * (PER_PRODUCER + 1) / 2;
+	TEST_ASSERT_EQUAL_UINT(expected, mpsc_aggregator_stop(&agg));
+	TEST_ASSERT_EQUAL_UINT(PRODUCERS * PER_PRODUCER, atomic_load(&agg.applied));
+}
+
+void test_mpsc_size_read_by_producers_never_underflows(void) {
+	MpscAggregator agg;
+	pthread_t producers[PRODUCERS];
+	size_t largest[PRODUCERS] = {0};
+	TEST_ASSERT_TRUE(mpsc_aggregator_start(&agg, &ring));
+	for (int i = 0; i < PRODUCERS; i++)
+		pthread_create(&producers[i], NULL, s_produce_watching, &largest[i]);
+	for (int i = 0; i < PRODUCERS; i++) {
+		pthread_join(producers[i], NULL);
+		TEST_ASSERT_TRUE(largest[i] <= PRODUCERS * PER_PRODUCER);
+	}
+	Currency expected = PRODUCERS * (Currency) PER_PRODUCER * (PER_PRODUCER + 1) / 2;
+	TEST_ASSERT_EQUAL_UINT(expected, mpsc_aggregator_stop(&agg));
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_mpsc_init_rejects_invalid_capacity);
+	RUN_TEST(test_mpsc_pop_batch_preserves_order);
+	RUN_TEST(test_mpsc_push_reports_full_ring);
+	RUN_TEST(test_mpsc_aggregator_totals_all_producers);
+	RUN_TEST(test_mpsc_size_read_by_producers_never_underflows);
+	return UNITY_END();
+}
@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "unity/unity.h"
+#include "pipeline.h"
+#include "journal.h"
+
+
+#define LINES 300000
+
+
+static FILE *journal;
+
+
+// Run before each test
+void setUp(void) {
+	journal = tmpfile();
+	TEST_ASSERT_NOT_NULL(journal);
+}
+
+// Run after each test
+void tearDown(void) {
+	fclose(journal);
+}
+
+void test_pipeline_total_matches_line_by_line_sum(void) {
+	JournalTotal result;
+	Currency expected = 0;
+	// Enough lines of varying width to span several buffers at unaligned offsets
+	for (unsigned long i = 0; i < LINES; i++) {
+		Currency amount = (i * 7919) % 1000003;
+		fprintf(journal, "$%lu.%02lu\n", amount / 100, amount % 100);
+		expected += amount;
+	}
+	fputs("junk\n9.07x3", journal);
+	expected += 2721;
+	fflush(journal);
+	rewind(journal);
+	TEST_ASSERT_TRUE(pipeline_total(fileno(journal), INGEST_AUTO, &result, NULL));
+	TEST_ASSERT_EQUAL_UINT(expected, result.total);
+	TEST_ASSERT_EQUAL_UINT(LINES + 2, result.lines);
+	// Both readers see the same journal
+	rewind(journal);
+	TEST_ASSERT_TRUE(pipeline_total(fileno(journal), INGEST_PREAD, &result, NULL));
+	TEST_ASSERT_EQUAL_UINT(expected, result.total);
+	TEST_ASSERT_EQUAL_UINT(LINES + 2, result.lines);
+}
+
+void test_pipeline_total_counts_overlong_line_once(void) {
+	JournalTotal result, mapped;
+	size_t widths[] = {PIPELINE_CARRY_SIZE + 1, 3 * PIPELINE_CARRY_SIZE, 2 * PIPELINE_BUFFER_SIZE};
+	// Lines longer than the carry space, one spanning whole buffers, each end in a valid
+	// 	amount that must not be scanned on its own
+	for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+		fputs("1.00\n", journal);
+		for (size_t i = 0; i < widths[w]; i++)
+			fputc(' ', journal);
+		fputs("5.00\n", journal);
+	}
+	fputs("2.00\n", journal);
+	fflush(journal);
+	rewind(journal);
+	TEST_ASSERT_TRUE(journal_total_mapped(fileno(journal), &mapped, NULL));
+	rewind(journal);
+	TEST_ASSERT_TRUE(pipeline_total(fileno(journal), INGEST_PREAD, &result, NULL));
+	TEST_ASSERT_EQUAL_UINT(mapped.lines, result.lines);
+	TEST_ASSERT_EQUAL_UINT(mapped.total, result.total);
+	TEST_ASSERT_EQUAL_UINT(result.lines / 2 * 100 + 200, result.total);
+}
+
+void test_pipeline_total_handles_empty_journal(void) {
+	JournalTotal result;
+	TEST_ASSERT_TRUE(pipeline_total(fileno(journal), INGEST_AUTO, &result, NULL));
+	TEST_ASSERT_EQUAL_UINT(0, result.total);
+	TEST_ASSERT_EQUAL_UINT(0, result.lines);
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_pipeline_total_matches_line_by_line_sum);
+	RUN_TEST(test_pipeline_total_counts_overlong_line_once);
+	RUN_TEST(test_pipeline_total_handles_empty_journal);
+	return UNITY_END();
+}
@@ -0,0 +1,75 @@
+#include <sched.h>
+#include <stdatomic.h>
+
+#include "unity/unity.h"
+#include "pool.h"
+
+
+#define WORKERS 4
+#define LEAVES  1000
+
+
+static Pool *pool;
+static atomic_ulong sum;
+
+
+static void s_add(Pool *p, void *arg) {
+	atomic_fetch_add(&sum, (unsigned long) arg);
+}
+
+// Split into LEAVES tasks from within the pool, as settle splits large files
+static void s_split(Pool *p, void *arg) {
+	for (unsigned long i = 1; i <= LEAVES; i++)
+		pool_submit(p, s_add, (void*) i);
+}
+
+// Run before each test
+void setUp(void) {
+	atomic_store(&sum, 0);
+	pool = pool_create(WORKERS);
+	TEST_ASSERT_NOT_NULL(pool);
+}
+
+// Run after each test
+void tearDown(void) {
+	pool_destroy(pool);
+}
+
+void test_pool_runs_every_task(void) {
+	for (unsigned long i = 1; i <= LEAVES; i++)
+		pool_submit(pool, s_add, (void*) i);
+	pool_wait(pool);
+	TEST_ASSERT_EQUAL_UINT(LEAVES * (LEAVES + 1) / 2, atomic_load(&sum));
+}
+
+void test_pool_wait_covers_nested_tasks(void) {
+	for (int i = 0; i < WORKERS; i++)
+		pool_submit(pool, s_split, NULL);
+	pool_wait(pool);
+	TEST_ASSERT_EQUAL_UINT(WORKERS * LEAVES * (LEAVES + 1) / 2, atomic_load(&sum));
+}
+
+void test_pool_idle_workers_sleep_until_woken(void) {
+	// Idle workers stop spinning once they have looked for tasks POOL_SPINS times
+	for (unsigned long tries = 0; atomic_load(&pool->sleepers) < WORKERS && tries < 1000000; tries++)
+		sched_yield();
+	TEST_ASSERT_EQUAL_UINT(WORKERS, atomic_load(&pool->sleepers));
+	for (unsigned long i = 1; i <= LEAVES; i++)
+		pool_submit(pool, s_add, (void*) i);
+	pool_wait(pool);
+	TEST_ASSERT_EQUAL_UINT(LEAVES * (LEAVES + 1) / 2, atomic_load(&sum));
+}
+
+void test_pool_create_rejects_no_workers(void) {
+	TEST_ASSERT_NULL(pool_create(0));
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_pool_runs_every_task);
+	RUN_TEST(test_pool_wait_covers_nested_tasks);
+	RUN_TEST(test_pool_idle_workers_sleep_until_woken);
+	RUN_TEST(test_pool_create_rejects_no_workers);
+	return UNITY_END();
+}
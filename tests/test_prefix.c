@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "unity/unity.h"
+#include "prefix.h"
+
+
+#define LINES  1000
+#define STRIDE 16
+
+
+static char journal[LINES * 16];
+static Currency running[LINES + 1];     // running[n] is the sum of the first n entries
+static size_t len;
+static PrefixIndex idx;
+
+
+// Run before each test
+void setUp(void) {
+	len = 0;
+	running[0] = 0;
+	for (int i = 0; i < LINES; i++) {
+		Currency amount = (i * 7919) % 100003;
+		len += sprintf(journal + len, "%lu.%02lu\n", amount / 100, amount % 100);
+		running[i+1] = running[i] + amount;
+	}
+	prefix_init(&idx, STRIDE);
+}
+
+// Run after each test
+void tearDown(void) {
+	prefix_free(&idx);
+}
+
+void test_prefix_range_matches_running_sums(void) {
+	Currency total;
+	TEST_ASSERT_TRUE(prefix_update(&idx, journal, len));
+	TEST_ASSERT_EQUAL_UINT(LINES, idx.entries);
+	TEST_ASSERT_EQUAL_UINT(running[LINES], idx.total);
+	uint64 ranges[][2] = {{1, 1}, {1, LINES}, {16, 17}, {17, 32}, {203, 980}, {LINES, LINES}};
+	for (size_t i = 0; i < sizeof(ranges) / sizeof(ranges[0]); i++) {
+		TEST_ASSERT_TRUE(prefix_range(&idx, journal, ranges[i][0], ranges[i][1], &total));
+		TEST_ASSERT_EQUAL_UINT(running[ranges[i][1]] - running[ranges[i][0] - 1], total);
+	}
+}
+
+void test_prefix_range_rejects_invalid_ranges(void) {
+	Currency total;
+	prefix_update(&idx, journal, len);
+	TEST_ASSERT_FALSE(prefix_range(&idx, journal, 0, 5, &total));
+	TEST_ASSERT_FALSE(prefix_range(&idx, journal, 6, 5, &total));
+	TEST_ASSERT_FALSE(prefix_range(&idx, journal, 1, LINES + 1, &total));
+}
+
+void test_prefix_update_extends_over_appended_lines(void) {
+	Currency total;
+	// Stop mid-line; the partial line is left for a later update
+	size_t part = len / 3 + 2;
+	TEST_ASSERT_TRUE(prefix_update(&idx, journal, part));
+	TEST_ASSERT_EQUAL_CHAR('\n', journal[idx.covered - 1]);
+	uint64 seen = idx.entries;
+	TEST_ASSERT_TRUE(prefix_update(&idx, journal, len));
+	TEST_ASSERT_EQUAL_UINT(LINES, idx.entries);
+	TEST_ASSERT_TRUE(prefix_range(&idx, journal, seen, seen + 1, &total));
+	TEST_ASSERT_EQUAL_UINT(running[seen + 1] - running[seen - 1], total);
+	TEST_ASSERT_EQUAL_UINT(LINES / STRIDE + 1, idx.count);
+	TEST_ASSERT_FALSE(prefix_update(&idx, journal, part));
+}
+
+void test_prefix_update_rejects_rewritten_journal(void) {
+	TEST_ASSERT_TRUE(prefix_update(&idx, journal, len / 2));
+	// Same length, different amounts: the journal was rewritten, not appended to
+	journal[idx.covered - 2] = journal[idx.covered - 2] == '9' ? '8' : '9';
+	TEST_ASSERT_FALSE(prefix_update(&idx, journal, len));
+}
+
+void test_prefix_save_and_load_round_trip(void) {
+	PrefixIndex loaded;
+	Currency total;
+	char path[] = "/tmp/test_prefix.XXXXXX";
+	close(mkstemp(path));
+	prefix_update(&idx, journal, len);
+	TEST_ASSERT_TRUE(prefix_save(&idx, path));
+	TEST_ASSERT_TRUE(prefix_load(&loaded, path));
+	TEST_ASSERT_EQUAL_UINT(idx.entries, loaded.entries);
+	TEST_ASSERT_EQUAL_UINT(idx.covered, loaded.covered);
+	TEST_ASSERT_EQUAL_UINT64(idx.fingerprint, loaded.fingerprint);
+	TEST_ASSERT_TRUE(prefix_range(&loaded, journal, 100, 900, &total));
+	TEST_ASSERT_EQUAL_UINT(running[900] - running[99], total);
+	prefix_free(&loaded);
+	remove(path);
+	TEST_ASSERT_FALSE(prefix_load(&loaded, path));
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_prefix_range_matches_running_sums);
+	RUN_TEST(test_prefix_range_rejects_invalid_ranges);
+	RUN_TEST(test_prefix_update_extends_over_appended_lines);
+	RUN_TEST(test_prefix_update_rejects_rewritten_journal);
+	RUN_TEST(test_prefix_save_and_load_round_trip);
+	return UNITY_END();
+}
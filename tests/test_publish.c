@@ -0,0 +1,57 @@
+#include <stdio.h>
+#include <unistd.h>
+
+#include "unity/unity.h"
+#include "publish.h"
+
+
+static char name[64];
+static PublishedTotal *published;
+
+
+// Run before each test
+void setUp(void) {
+	snprintf(name, sizeof(name), "/%s_test_%d", PROGRAM_TITLE, (int) getpid());
+	published = publish_open(name);
+	TEST_ASSERT_NOT_NULL(published);
+}
+
+// Run after each test
+void tearDown(void) {
+	publish_close(published, name);
+}
+
+void test_publish_open_starts_at_zero(void) {
+	const PublishedTotal *reader = publish_attach(name);
+	TEST_ASSERT_NOT_NULL(reader);
+	TotalSnapshot snap = publish_read(reader);
+	TEST_ASSERT_EQUAL_UINT(0, snap.total);
+	TEST_ASSERT_EQUAL_UINT(0, snap.count);
+	TEST_ASSERT_NOT_EQUAL(0, snap.updated_ns);
+	publish_detach(reader);
+}
+
+void test_publish_update_is_seen_by_readers(void) {
+	const PublishedTotal *reader = publish_attach(name);
+	TotalSnapshot before = publish_read(reader);
+	publish_update(published, 3258, 2);
+	TotalSnapshot snap = publish_read(reader);
+	TEST_ASSERT_EQUAL_UINT(3258, snap.total);
+	TEST_ASSERT_EQUAL_UINT(2, snap.count);
+	TEST_ASSERT_TRUE(snap.updated_ns >= before.updated_ns);
+	TEST_ASSERT_EQUAL_UINT(0, atomic_load(&reader->seq) & 1);
+	publish_detach(reader);
+}
+
+void test_publish_attach_fails_without_segment(void) {
+	TEST_ASSERT_NULL(publish_attach("/" PROGRAM_TITLE "_no_such_segment"));
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_publish_open_starts_at_zero);
+	RUN_TEST(test_publish_update_is_seen_by_readers);
+	RUN_TEST(test_publish_attach_fails_without_segment);
+	return UNITY_END();
+}
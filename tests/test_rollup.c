@@ -0,0 +1,77 @@
+#include <time.h>
+
+#include "unity/unity.h"
+#include "rollup.h"
+
+
+#define MINUTE (60 * ROLLUP_NS_PER_SEC)
+#define HOUR   (60 * MINUTE)
+#define DAY    (24 * HOUR)
+
+
+static Rollups rollups;
+static uint64 start;
+
+
+// Run before each test
+void setUp(void) {
+	rollup_init(&rollups);
+	// Tests work in UTC, from the start of an arbitrary day
+	rollups.offset = 0;
+	start = 20000 * DAY;
+}
+
+// Run after each test
+void tearDown(void) {
+
+}
+
+void test_rollup_add_sums_by_period(void) {
+	rollup_add(&rollups, start + 10 * ROLLUP_NS_PER_SEC, 500, 1);
+	rollup_add(&rollups, start + 50 * ROLLUP_NS_PER_SEC, 250, 1);
+	rollup_add(&rollups, start + 2 * MINUTE, 100, 1);
+	RollupBucket b = rollup_get(&rollups, ROLLUP_MINUTE, start);
+	TEST_ASSERT_EQUAL_UINT(750, b.total);
+	TEST_ASSERT_EQUAL_UINT(2, b.count);
+	TEST_ASSERT_EQUAL_UINT(0, rollup_get(&rollups, ROLLUP_MINUTE, start + MINUTE).total);
+	rollup_add(&rollups, start + 3 * HOUR, 7, 1);
+	TEST_ASSERT_EQUAL_UINT(850, rollup_get(&rollups, ROLLUP_HOUR, start + 59 * MINUTE).total);
+	TEST_ASSERT_EQUAL_UINT(857, rollup_get(&rollups, ROLLUP_DAY, start + 23 * HOUR).total);
+}
+
+void test_rollup_add_subtracts_voids_and_edits(void) {
+	rollup_add(&rollups, start, 500, 1);
+	rollup_add(&rollups, start, 300, 1);
+	rollup_add(&rollups, start, -500, -1);
+	rollup_add(&rollups, start, 200 - 300, 0);
+	RollupBucket b = rollup_get(&rollups, ROLLUP_HOUR, start);
+	TEST_ASSERT_EQUAL_UINT(200, b.total);
+	TEST_ASSERT_EQUAL_UINT(1, b.count);
+}
+
+void test_rollup_reuses_buckets_of_expired_periods(void) {
+	rollup_add(&rollups, start, 500, 1);
+	rollup_add(&rollups, start + ROLLUP_MINUTES * MINUTE, 10, 1);
+	TEST_ASSERT_EQUAL_UINT(0, rollup_get(&rollups, ROLLUP_MINUTE, start).total);
+	TEST_ASSERT_EQUAL_UINT(10, rollup_get(&rollups, ROLLUP_MINUTE, start + ROLLUP_MINUTES * MINUTE).total);
+	// Sales older than the periods kept are dropped
+	rollup_add(&rollups, start, 500, 1);
+	TEST_ASSERT_EQUAL_UINT(10, rollup_get(&rollups, ROLLUP_MINUTE, start + ROLLUP_MINUTES * MINUTE).total);
+	TEST_ASSERT_EQUAL_UINT(1000, rollup_get(&rollups, ROLLUP_HOUR, start).total);
+}
+
+void test_rollup_now_is_near_realtime(void) {
+	uint64 now = rollup_now();
+	TEST_ASSERT_TRUE(now / ROLLUP_NS_PER_SEC + 1 >= (uint64) time(NULL));
+	TEST_ASSERT_TRUE(now / ROLLUP_NS_PER_SEC <= (uint64) time(NULL));
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_rollup_add_sums_by_period);
+	RUN_TEST(test_rollup_add_subtracts_voids_and_edits);
+	RUN_TEST(test_rollup_reuses_buckets_of_expired_periods);
+	RUN_TEST(test_rollup_now_is_near_realtime);
+	return UNITY_END();
+}
@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "unity/unity.h"
+#include "io.h"
+#include "running.h"
+
+
+static FILE *journal, *output;
+
+
+// Read everything written to output
+static char *s_read_output(size_t *len) {
+	fflush(output);
+	*len = ftell(output);
+	char *buf = malloc(*len + 1);
+	rewind(output);
+	TEST_ASSERT_EQUAL_UINT(*len, fread(buf, 1, *len, output));
+	buf[*len] = '\0';
+	return buf;
+}
+
+
+// Run before each test
+void setUp(void) {
+	journal = tmpfile();
+	output = tmpfile();
+}
+
+// Run after each test
+void tearDown(void) {
+	fclose(journal);
+	fclose(output);
+}
+
+void test_running_totals_match_repl_lines(void) {
+	// Spans several chunks, with a partial line, an invalid line and no final newline
+	unsigned long lines = 3 * RUNNING_CHUNK_SIZE / 8;
+	size_t expected_len = 0, capacity = lines * 32, len;
+	char *expected = malloc(capacity);
+	Currency total = 0;
+	for (unsigned long i = 0; i < lines; i++) {
+		Currency amount = (i * 7919) % 100000;
+		if (i == lines / 2)
+			fprintf(journal, "Hello\n");
+		else if (i + 1 == lines)
+			fprintf(journal, "%lu.%02lu", amount / 100, amount % 100);
+		else
+			fprintf(journal, "%lu.%02lu\n", amount / 100, amount % 100);
+		if (i != lines / 2)
+			total += amount;
+		expected_len += strlen(sprint_currency(expected + expected_len, capacity - expected_len, "=> %s\n", total));
+	}
+	fflush(journal);
+	TEST_ASSERT_TRUE(running_totals(fileno(journal), fileno(output), 3));
+	char *actual = s_read_output(&len);
+	TEST_ASSERT_EQUAL_UINT(expected_len, len);
+	TEST_ASSERT_EQUAL_MEMORY(expected, actual, len);
+	free(expected);
+	free(actual);
+}
+
+void test_running_totals_handles_empty_and_unmappable(void) {
+	size_t len;
+	int fds[2];
+	TEST_ASSERT_TRUE(running_totals(fileno(journal), fileno(output), 2));
+	free(s_read_output(&len));
+	TEST_ASSERT_EQUAL_UINT(0, len);
+	TEST_ASSERT_EQUAL_INT(0, pipe(fds));
+	TEST_ASSERT_FALSE(running_totals(fds[0], fileno(output), 2));
+	close(fds[0]);
+	close(fds[1]);
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_running_totals_match_repl_lines);
+	RUN_TEST(test_running_totals_handles_empty_and_unmappable);
+	return UNITY_END();
+}
@@ -0,0 +1,72 @@
+#include <pthread.h>
+#include <stdint.h>
+
+#include "unity/unity.h"
+#include "shard.h"
+
+
+#define THREADS    4
+#define PER_THREAD 50000
+
+
+static ShardedTotal sharded;
+
+
+// Claim a shard, then add the amounts 1 through PER_THREAD to it
+static void *s_add_all(void *arg) {
+	size_t shard = shard_claim(&sharded);
+	for (Currency i = 1; i <= PER_THREAD; i++)
+		shard_add(&sharded, shard, i);
+	return NULL;
+}
+
+// Run before each test
+void setUp(void) {
+	TEST_ASSERT_TRUE(shard_init(&sharded, THREADS));
+}
+
+// Run after each test
+void tearDown(void) {
+	shard_free(&sharded);
+}
+
+void test_shards_fill_whole_cache_lines(void) {
+	TEST_ASSERT_EQUAL_UINT(CACHE_LINE_SIZE, sizeof(Shard));
+	TEST_ASSERT_EQUAL_UINT(0, (uintptr_t) sharded.shards % CACHE_LINE_SIZE);
+}
+
+void test_shard_claim_stops_at_count(void) {
+	for (size_t i = 0; i < THREADS; i++)
+		TEST_ASSERT_EQUAL_UINT(i, shard_claim(&sharded));
+	TEST_ASSERT_EQUAL_UINT(SHARD_NONE, shard_claim(&sharded));
+}
+
+void test_shard_sum_combines_shards(void) {
+	shard_add(&sharded, 0, 537);
+	shard_add(&sharded, 1, 2721);
+	shard_add(&sharded, 3, 100);
+	TEST_ASSERT_EQUAL_UINT(3358, shard_sum(&sharded));
+}
+
+void test_shard_snapshot_counts_adds(void) {
+	uint64 adds;
+	pthread_t threads[THREADS];
+	for (int i = 0; i < THREADS; i++)
+		pthread_create(&threads[i], NULL, s_add_all, NULL);
+	for (int i = 0; i < THREADS; i++)
+		pthread_join(threads[i], NULL);
+	Currency expected = THREADS * (Currency) PER_THREAD * (PER_THREAD + 1) / 2;
+	TEST_ASSERT_EQUAL_UINT(expected, shard_snapshot(&sharded, &adds));
+	TEST_ASSERT_EQUAL_UINT(THREADS * PER_THREAD, adds);
+	TEST_ASSERT_EQUAL_UINT(expected, shard_sum(&sharded));
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_shards_fill_whole_cache_lines);
+	RUN_TEST(test_shard_claim_stops_at_count);
+	RUN_TEST(test_shard_sum_combines_shards);
+	RUN_TEST(test_shard_snapshot_counts_adds);
+	return UNITY_END();
+}
@@ -0,0 +1,86 @@
+#include <stdlib.h>
+
+#include "unity/unity.h"
+#include "sketch.h"
+
+
+#define AMOUNTS 1000000
+#define RANGE    100000
+#define ERROR_MARGIN (RANGE / 100)  // Within 1% of rank
+
+
+static Sketch a, b;
+
+
+// Run before each test
+void setUp(void) {
+	sketch_init(&a);
+	sketch_init(&b);
+}
+
+// Run after each test
+void tearDown(void) {
+
+}
+
+void test_sketch_quantile_of_empty_is_zero(void) {
+	TEST_ASSERT_EQUAL_UINT(0, sketch_quantile(&a, 0.5));
+}
+
+void test_sketch_quantile_is_exact_while_small(void) {
+	for (Currency i = 1; i <= 100; i++)
+		sketch_add(&a, 101 - i);
+	TEST_ASSERT_EQUAL_UINT(1, sketch_quantile(&a, 0));
+	TEST_ASSERT_EQUAL_UINT(50, sketch_quantile(&a, 0.5));
+	TEST_ASSERT_EQUAL_UINT(95, sketch_quantile(&a, 0.95));
+	TEST_ASSERT_EQUAL_UINT(100, sketch_quantile(&a, 1));
+}
+
+void test_sketch_quantile_estimates_large_streams(void) {
+	// Every amount in the range, in a shuffled order
+	for (unsigned long i = 0; i < AMOUNTS; i++)
+		sketch_add(&a, (i * 7919) % AMOUNTS * RANGE / AMOUNTS);
+	TEST_ASSERT_EQUAL_UINT(AMOUNTS, a.count);
+	TEST_ASSERT_UINT_WITHIN(ERROR_MARGIN, RANGE / 2, sketch_quantile(&a, 0.5));
+	TEST_ASSERT_UINT_WITHIN(ERROR_MARGIN, RANGE * 95 / 100, sketch_quantile(&a, 0.95));
+	TEST_ASSERT_UINT_WITHIN(ERROR_MARGIN, RANGE * 99 / 100, sketch_quantile(&a, 0.99));
+}
+
+void test_sketch_merge_combines_streams(void) {
+	// Each sketch sees half of the range
+	for (unsigned long i = 0; i < AMOUNTS; i++) {
+		Currency amount = (i * 7919) % AMOUNTS * RANGE / AMOUNTS;
+		sketch_add(amount < RANGE / 2 ? &a : &b, amount);
+	}
+	sketch_merge(&a, &b);
+	TEST_ASSERT_EQUAL_UINT(AMOUNTS, a.count);
+	TEST_ASSERT_UINT_WITHIN(ERROR_MARGIN, RANGE / 4, sketch_quantile(&a, 0.25));
+	TEST_ASSERT_UINT_WITHIN(ERROR_MARGIN, RANGE / 2, sketch_quantile(&a, 0.5));
+	TEST_ASSERT_UINT_WITHIN(ERROR_MARGIN, RANGE * 99 / 100, sketch_quantile(&a, 0.99));
+}
+
+void test_sketch_compacts_full_top_level_in_place(void) {
+	// Fill the top two levels, as only ~2^40 amounts would, then merge more into them
+	for (size_t h = SKETCH_LEVELS - 2; h < SKETCH_LEVELS; h++) {
+		for (Currency i = 0; i < SKETCH_K; i++)
+			a.levels[h][i] = b.levels[h][i] = i;
+		a.sizes[h] = b.sizes[h] = SKETCH_K;
+	}
+	sketch_merge(&a, &b);
+	for (size_t h = 0; h < SKETCH_LEVELS; h++)
+		TEST_ASSERT_LESS_OR_EQUAL_UINT(SKETCH_K, a.sizes[h]);
+	TEST_ASSERT_GREATER_THAN_UINT(0, a.sizes[SKETCH_LEVELS - 1]);
+	Currency median = sketch_quantile(&a, 0.5);
+	TEST_ASSERT_UINT_WITHIN(SKETCH_K / 4, SKETCH_K / 2, median);
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_sketch_quantile_of_empty_is_zero);
+	RUN_TEST(test_sketch_quantile_is_exact_while_small);
+	RUN_TEST(test_sketch_quantile_estimates_large_streams);
+	RUN_TEST(test_sketch_merge_combines_streams);
+	RUN_TEST(test_sketch_compacts_full_top_level_in_place);
+	return UNITY_END();
+}
@@ -0,0 +1,60 @@
+#include <pthread.h>
+#include <stdint.h>
+
+#include "unity/unity.h"
+#include "spsc.h"
+
+
+#define CAPACITY 8
+#define ITEMS    100000
+
+
+static SpscRing ring;
+
+
+// Push the pointers 1 through ITEMS, in order
+static void *s_produce(void *arg) {
+	for (uintptr_t i = 1; i <= ITEMS; i++)
+		spsc_push_wait(&ring, (void*) i);
+	return NULL;
+}
+
+// Run before each test
+void setUp(void) {
+	TEST_ASSERT_TRUE(spsc_init(&ring, CAPACITY));
+}
+
+// Run after each test
+void tearDown(void) {
+	spsc_free(&ring);
+}
+
+void test_spsc_push_reports_full_ring(void) {
+	int items[CAPACITY];
+	for (int i = 0; i < CAPACITY; i++)
+		TEST_ASSERT_TRUE(spsc_push(&ring, &items[i]));
+	TEST_ASSERT_FALSE(spsc_push(&ring, &items[0]));
+	TEST_ASSERT_EQUAL_PTR(&items[0], spsc_pop(&ring));
+	TEST_ASSERT_TRUE(spsc_push(&ring, &items[0]));
+}
+
+void test_spsc_pop_returns_null_when_empty(void) {
+	TEST_ASSERT_NULL(spsc_pop(&ring));
+}
+
+void test_spsc_preserves_order_across_threads(void) {
+	pthread_t producer;
+	pthread_create(&producer, NULL, s_produce, NULL);
+	for (uintptr_t i = 1; i <= ITEMS; i++)
+		TEST_ASSERT_EQUAL_PTR((void*) i, spsc_pop_wait(&ring));
+	pthread_join(producer, NULL);
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_spsc_push_reports_full_ring);
+	RUN_TEST(test_spsc_pop_returns_null_when_empty);
+	RUN_TEST(test_spsc_preserves_order_across_threads);
+	return UNITY_END();
+}
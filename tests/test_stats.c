@@ -0,0 +1,78 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "unity/unity.h"
+#include "stats.h"
+
+
+static Stats stats;
+
+
+// Run before each test
+void setUp(void) {
+	stats_init(&stats);
+}
+
+// Run after each test
+void tearDown(void) {
+
+}
+
+void test_stats_add_maintains_aggregates(void) {
+	Currency amounts[] = {537, 5, 100500037, 2721, 0};
+	for (size_t i = 0; i < sizeof(amounts) / sizeof(amounts[0]); i++)
+		stats_add(&stats, amounts[i]);
+	TEST_ASSERT_EQUAL_UINT(5, stats.count);
+	TEST_ASSERT_EQUAL_UINT(100503300, stats.sum);
+	TEST_ASSERT_EQUAL_UINT(0, stats.min);
+	TEST_ASSERT_EQUAL_UINT(100500037, stats.max);
+	TEST_ASSERT_EQUAL_UINT(20100660, stats_mean(&stats));
+	TEST_ASSERT_EQUAL_UINT(5, stats.histogram.count);
+	TEST_ASSERT_EQUAL_UINT(1, stats.histogram.buckets[histogram_index(537)]);
+	TEST_ASSERT_EQUAL_UINT(1, stats.histogram.buckets[0]);
+}
+
+void test_stats_scan_skips_invalid_and_partial_lines(void) {
+	const char *data = "$5.37\nHello\n9.07x3\r\n\n12";
+	TEST_ASSERT_EQUAL_UINT(strlen(data) - 2, stats_scan(&stats, data, strlen(data)));
+	TEST_ASSERT_EQUAL_UINT(2, stats.count);
+	TEST_ASSERT_EQUAL_UINT(537 + 2721, stats.sum);
+}
+
+void test_stats_save_and_load_round_trip(void) {
+	Stats loaded;
+	StatsMark mark = {17, 5, 0x1234}, loaded_mark;
+	char path[] = "/tmp/test_stats.XXXXXX";
+	struct stat st;
+	close(mkstemp(path));
+	for (Currency i = 0; i < 5000; i++)
+		stats_add(&stats, i * 7919 % 10007);
+	TEST_ASSERT_TRUE(stats_save(&stats, &mark, path));
+	TEST_ASSERT_TRUE(stats_load(&loaded, &loaded_mark, path));
+	TEST_ASSERT_EQUAL_MEMORY(&mark, &loaded_mark, sizeof(StatsMark));
+	TEST_ASSERT_EQUAL_MEMORY(&stats, &loaded, offsetof(Stats, quantiles.levels));
+	for (size_t h = 0; h < SKETCH_LEVELS; h++) {
+		TEST_ASSERT_EQUAL_UINT(stats.quantiles.sizes[h], loaded.quantiles.sizes[h]);
+		if (stats.quantiles.sizes[h] > 0)
+			TEST_ASSERT_EQUAL_MEMORY(stats.quantiles.levels[h], loaded.quantiles.levels[h],
+					stats.quantiles.sizes[h] * sizeof(Currency));
+	}
+	TEST_ASSERT_EQUAL_UINT(sketch_quantile(&stats.quantiles, 0.95), sketch_quantile(&loaded.quantiles, 0.95));
+	// Only the amounts the sketch holds are written, not its whole 64 KiB
+	TEST_ASSERT_EQUAL_INT(0, stat(path, &st));
+	TEST_ASSERT_LESS_THAN_UINT(sizeof(Stats) / 4, st.st_size);
+	remove(path);
+	TEST_ASSERT_FALSE(stats_load(&loaded, &loaded_mark, path));
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_stats_add_maintains_aggregates);
+	RUN_TEST(test_stats_scan_skips_invalid_and_partial_lines);
+	RUN_TEST(test_stats_save_and_load_round_trip);
+	return UNITY_END();
+}
@@ -0,0 +1,83 @@
+#include <stdlib.h>
+
+#include "unity/unity.h"
+#include "sum.h"
+
+
+#define AMOUNTS (3 * SUM_BLOCK + 13)
+
+
+static Currency amounts[AMOUNTS];
+static const SumKernel kernels[] = {SUM_SCALAR, SUM_SSE, SUM_AVX2, SUM_AVX512, SUM_AUTO};
+
+
+// Total amounts one at a time in 128 bits, as a reference
+static void s_reference(const Currency *in, size_t n, Sum *out) {
+	unsigned __int128 total = 0;
+	for (size_t i = 0; i < n; i++)
+		total += in[i];
+	out->low = (Currency) total;
+	out->high = (uint64) (total >> 64);
+}
+
+
+// Run before each test
+void setUp(void) {
+	srand(1);
+	for (size_t i = 0; i < AMOUNTS; i++)
+		amounts[i] = rand() % 100000;
+}
+
+// Run after each test
+void tearDown(void) {
+
+}
+
+void test_sum_kernels_match_reference(void) {
+	Sum expected, actual;
+	size_t lengths[] = {0, 1, 7, 16, SUM_BLOCK, SUM_BLOCK + 1, AMOUNTS};
+	for (size_t l = 0; l < sizeof(lengths) / sizeof(*lengths); l++) {
+		s_reference(amounts, lengths[l], &expected);
+		for (size_t k = 0; k < sizeof(kernels) / sizeof(*kernels); k++) {
+			sum_init(&actual);
+			sum_amounts(&actual, amounts, lengths[l], kernels[k]);
+			TEST_ASSERT_EQUAL_UINT64(expected.low, actual.low);
+			TEST_ASSERT_EQUAL_UINT64(0, actual.high);
+			TEST_ASSERT_TRUE(sum_fits(&actual));
+		}
+	}
+}
+
+void test_sum_carries_overflowing_blocks(void) {
+	Sum expected, actual;
+	// Large amounts in one block only, so it alone falls back to the 128-bit accumulator
+	for (size_t i = SUM_BLOCK; i < 2 * SUM_BLOCK; i += 3)
+		amounts[i] = (Currency) -1 - i;
+	s_reference(amounts, AMOUNTS, &expected);
+	TEST_ASSERT_NOT_EQUAL(0, expected.high);
+	for (size_t k = 0; k < sizeof(kernels) / sizeof(*kernels); k++) {
+		sum_init(&actual);
+		sum_amounts(&actual, amounts, AMOUNTS, kernels[k]);
+		TEST_ASSERT_EQUAL_UINT64(expected.low, actual.low);
+		TEST_ASSERT_EQUAL_UINT64(expected.high, actual.high);
+		TEST_ASSERT_FALSE(sum_fits(&actual));
+	}
+}
+
+void test_sum_accumulates_across_calls(void) {
+	Sum expected, actual;
+	s_reference(amounts, AMOUNTS, &expected);
+	sum_init(&actual);
+	sum_amounts(&actual, amounts, 100, SUM_AUTO);
+	sum_amounts(&actual, amounts + 100, AMOUNTS - 100, SUM_AUTO);
+	TEST_ASSERT_EQUAL_UINT64(expected.low, actual.low);
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_sum_kernels_match_reference);
+	RUN_TEST(test_sum_carries_overflowing_blocks);
+	RUN_TEST(test_sum_accumulates_across_calls);
+	return UNITY_END();
+}
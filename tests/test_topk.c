@@ -0,0 +1,86 @@
+#include "unity/unity.h"
+#include "topk.h"
+
+
+#define ENTRIES 10000
+
+
+static TopK top;
+static TopEntry out[TOPK_MAX];
+
+
+// Run before each test
+void setUp(void) {
+	topk_init(&top, 5);
+}
+
+// Run after each test
+void tearDown(void) {
+
+}
+
+void test_topk_offer_keeps_largest_in_order(void) {
+	Currency amounts[] = {500, 100, 900, 300, 700, 200, 800, 600};
+	for (size_t i = 0; i < 8; i++)
+		topk_offer(&top, amounts[i], i + 1);
+	TEST_ASSERT_EQUAL_UINT(5, topk_sorted(&top, out));
+	Currency expected[] = {900, 800, 700, 600, 500};
+	uint64 lines[] = {3, 7, 5, 8, 1};
+	for (size_t i = 0; i < 5; i++) {
+		TEST_ASSERT_EQUAL_UINT(expected[i], out[i].amount);
+		TEST_ASSERT_EQUAL_UINT(lines[i], out[i].line);
+	}
+	TEST_ASSERT_EQUAL_UINT(501, top.threshold);
+}
+
+void test_topk_keeps_earliest_of_equal_amounts(void) {
+	for (uint64 line = 1; line <= 10; line++)
+		topk_offer(&top, 42, line);
+	topk_sorted(&top, out);
+	for (size_t i = 0; i < 5; i++)
+		TEST_ASSERT_EQUAL_UINT(i + 1, out[i].line);
+}
+
+void test_topk_offer_batch_matches_single_offers(void) {
+	Currency amounts[ENTRIES];
+	TopK single;
+	TopEntry expected[TOPK_MAX];
+	topk_init(&single, 5);
+	for (size_t i = 0; i < ENTRIES; i++) {
+		amounts[i] = (i * 7919) % 1000;
+		topk_offer(&single, amounts[i], i + 101);
+	}
+	topk_offer_batch(&top, amounts, ENTRIES / 2, 101);
+	topk_offer_batch(&top, amounts + ENTRIES / 2, ENTRIES / 2, 101 + ENTRIES / 2);
+	TEST_ASSERT_EQUAL_UINT(5, topk_sorted(&single, expected));
+	TEST_ASSERT_EQUAL_UINT(5, topk_sorted(&top, out));
+	TEST_ASSERT_EQUAL_MEMORY(expected, out, 5 * sizeof(TopEntry));
+}
+
+void test_topk_merge_offsets_lines(void) {
+	TopK first, second;
+	topk_init(&first, 5);
+	topk_init(&second, 5);
+	// Two halves of a journal, each numbered from its own first line
+	topk_offer(&first, 300, 1);
+	topk_offer(&first, 999, 2);
+	topk_offer(&second, 999, 1);
+	topk_offer(&second, 500, 2);
+	topk_merge(&top, &second, 2);
+	topk_merge(&top, &first, 0);
+	TEST_ASSERT_EQUAL_UINT(4, topk_sorted(&top, out));
+	TEST_ASSERT_EQUAL_UINT(2, out[0].line);
+	TEST_ASSERT_EQUAL_UINT(3, out[1].line);
+	TEST_ASSERT_EQUAL_UINT(4, out[2].line);
+	TEST_ASSERT_EQUAL_UINT(1, out[3].line);
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_topk_offer_keeps_largest_in_order);
+	RUN_TEST(test_topk_keeps_earliest_of_equal_amounts);
+	RUN_TEST(test_topk_offer_batch_matches_single_offers);
+	RUN_TEST(test_topk_merge_offsets_lines);
+	return UNITY_END();
+}
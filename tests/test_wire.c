@@ -0,0 +1,63 @@
+#include "unity/unity.h"
+#include "wire.h"
+
+
+static WireFrame frame;
+
+
+// Run before each test
+void setUp(void) {
+	wire_frame_init(&frame, 42);
+}
+
+// Run after each test
+void tearDown(void) {
+
+}
+
+void test_wire_frame_init_writes_valid_header(void) {
+	TEST_ASSERT_TRUE(wire_header_valid(&frame.header));
+	TEST_ASSERT_EQUAL_UINT(42, frame.header.session);
+	TEST_ASSERT_EQUAL_UINT(sizeof(WireHeader), wire_frame_size(&frame.header));
+}
+
+void test_wire_add_entries_grow_frame(void) {
+	TEST_ASSERT_TRUE(wire_add_currency(&frame, 907, 3));
+	TEST_ASSERT_TRUE(wire_add_percent(&frame, 10));
+	TEST_ASSERT_EQUAL_UINT(2, frame.header.count);
+	TEST_ASSERT_EQUAL_UINT(sizeof(WireHeader) + 2 * sizeof(WireEntry), wire_frame_size(&frame.header));
+	TEST_ASSERT_EQUAL_UINT(WIRE_CURRENCY, frame.entries[0].kind);
+	TEST_ASSERT_EQUAL_UINT(907, frame.entries[0].value);
+	TEST_ASSERT_EQUAL_UINT(3, frame.entries[0].multiplier);
+	TEST_ASSERT_EQUAL_UINT(WIRE_PERCENT, frame.entries[1].kind);
+	TEST_ASSERT_EQUAL_UINT(10, frame.entries[1].value);
+}
+
+void test_wire_add_rejects_full_frame(void) {
+	for (int i = 0; i < WIRE_MAX_ENTRIES; i++)
+		TEST_ASSERT_TRUE(wire_add_currency(&frame, 1, 1));
+	TEST_ASSERT_FALSE(wire_add_currency(&frame, 1, 1));
+	TEST_ASSERT_FALSE(wire_add_percent(&frame, 1));
+}
+
+void test_wire_header_valid_rejects_bad_headers(void) {
+	WireHeader header = frame.header;
+	header.magic = '$';
+	TEST_ASSERT_FALSE(wire_header_valid(&header));
+	header = frame.header;
+	header.version = WIRE_VERSION + 1;
+	TEST_ASSERT_FALSE(wire_header_valid(&header));
+	header = frame.header;
+	header.count = WIRE_MAX_ENTRIES + 1;
+	TEST_ASSERT_FALSE(wire_header_valid(&header));
+}
+
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_wire_frame_init_writes_valid_header);
+	RUN_TEST(test_wire_add_entries_grow_frame);
+	RUN_TEST(test_wire_add_rejects_full_frame);
+	RUN_TEST(test_wire_header_valid_rejects_bad_headers);
+	return UNITY_END();
+}
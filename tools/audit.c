@@ -0,0 +1,82 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utils.h"
+#include "io.h"
+#include "prefix.h"
+
+
+#define USAGE "usage: audit.bin [-n STRIDE] JOURNAL [FIRST LAST]..."
+
+
+int main(int argc, char **argv) {
+	uint32 stride = PREFIX_DEFAULT_STRIDE;
+	int opt;
+	while ((opt = getopt(argc, argv, "n:")) != -1) {
+		if (opt != 'n' || atol(optarg) <= 0) {
+			ERROR(USAGE);
+		}
+		stride = atol(optarg);
+	}
+	if (optind == argc || (argc - optind) % 2 == 0) {
+		ERROR(USAGE);
+	}
+	const char *path = argv[optind];
+	struct stat st;
+	int fd = open(path, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		ERROR("Unable to open journal");
+	}
+	size_t size = st.st_size;
+	const char *data = size > 0 ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : "";
+	if (data == MAP_FAILED) {
+		ERROR("Unable to map journal");
+	}
+	close(fd);
+
+	// Extend the sidecar index over whatever was appended since it was last saved
+	PrefixIndex idx;
+	char idx_path[strlen(path) + sizeof(PREFIX_SUFFIX)];
+	snprintf(idx_path, sizeof(idx_path), "%s%s", path, PREFIX_SUFFIX);
+	bool loaded = prefix_load(&idx, idx_path);
+	// An index sampled at another stride is rebuilt, its samples freed first
+	if (loaded && idx.stride != stride) {
+		prefix_free(&idx);
+		loaded = false;
+	}
+	if (!loaded || !prefix_update(&idx, data, size)) {
+		if (loaded)
+			prefix_free(&idx);
+		prefix_init(&idx, stride);
+		prefix_update(&idx, data, size);
+	}
+	if (!prefix_save(&idx, idx_path)) {
+		NONF_ERROR("Unable to save journal index");
+	}
+
+	int status = 0;
+	for (int i = optind + 1; i < argc; i += 2) {
+		uint64 first = strtoul(argv[i], NULL, 10), last = strtoul(argv[i+1], NULL, 10);
+		Currency total;
+		if (!prefix_range(&idx, data, first, last, &total)) {
+			fprintf(stderr, "%s: No entries %s through %s\n", PROGRAM_TITLE, argv[i], argv[i+1]);
+			status = 1;
+			continue;
+		}
+		printf("%lu-%lu: %lu entries ", first, last, last - first + 1);
+		print_currency("=> %s\n", total);
+	}
+	if (optind + 1 == argc) {
+		printf("%lu entries ", idx.entries);
+		print_currency("=> %s\n", idx.total);
+	}
+	prefix_free(&idx);
+	if (size > 0)
+		munmap((void*) data, size);
+	return status;
+}
@@ -0,0 +1,29 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "utils.h"
+#include "catalog.h"
+
+
+#define USAGE "usage: catalogc.bin CATALOG [IMAGE]"
+
+
+// Compile a text catalog into the image main.bin maps with -c, beside it unless IMAGE is given
+int main(int argc, char **argv) {
+	if (argc < 2 || argc > 3) {
+		ERROR(USAGE);
+	}
+	const char *path = argv[1];
+	char image[strlen(path) + sizeof(CATALOG_SUFFIX)];
+	snprintf(image, sizeof(image), "%s%s", path, CATALOG_SUFFIX);
+	Catalog catalog;
+	if (!catalog_load(&catalog, path)) {
+		ERROR("Unable to load catalog");
+	}
+	if (!catalog_save(&catalog, argc == 3 ? argv[2] : image)) {
+		ERROR("Unable to write compiled catalog");
+	}
+	printf("%lu products\n", catalog.count);
+	catalog_free(&catalog);
+	return 0;
+}
@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "utils.h"
+#include "io.h"
+
+
+#define USAGE "usage: loadgen.bin SOCKET [CLIENTS] [ENTRIES] [PIPELINE]"
+
+#define DEFAULT_CLIENTS     8
+#define DEFAULT_ENTRIES 100000
+#define DEFAULT_PIPELINE    64
+
+// Each entry sent is "$1.01"; the running total after n entries is n * 101 cents
+#define ENTRY      "$1.01\n"
+#define ENTRY_LEN  (sizeof(ENTRY) - 1)
+#define ENTRY_CENTS 101
+
+
+// Connect to the daemon's socket, or exit
+static int s_connect(const char *path) {
+	struct sockaddr_un addr = {.sun_family = AF_UNIX};
+	strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0 || connect(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0) {
+		ERROR("Unable to connect to daemon");
+	}
+	return fd;
+}
+
+// Play one register: send entries in pipelined batches, and check the final total
+static int s_client(const char *path, long entries, long pipeline) {
+	int fd = s_connect(path);
+	char *batch = malloc(pipeline * ENTRY_LEN);
+	char reply[4096], last[MAX_BUFFER_SIZE] = "";
+	size_t last_len = 0;
+	for (long i = 0; i < pipeline; i++)
+		memcpy(batch + i * ENTRY_LEN, ENTRY, ENTRY_LEN);
+
+	for (long sent = 0; sent < entries; ) {
+		long n = entries - sent < pipeline ? entries - sent : pipeline;
+		if (write(fd, batch, n * ENTRY_LEN) != (ssize_t) (n * ENTRY_LEN))
+			return 1;
+		sent += n;
+		// Wait for one reply line per entry sent, keeping the most recent
+		while (n > 0) {
+			ssize_t len = read(fd, reply, sizeof(reply));
+			if (len <= 0)
+				return 1;
+			for (ssize_t j = 0; j < len; j++) {
+				if (reply[j] == '\n') {
+					last[last_len] = '\0';
+					last_len = 0;
+					n--;
+				}
+				else if (last_len < MAX_BUFFER_SIZE - 1) {
+					last[last_len++] = reply[j];
+				}
+			}
+		}
+	}
+	char expected[MAX_BUFFER_SIZE];
+	sprint_currency(expected, MAX_BUFFER_SIZE, "=> %s", entries * ENTRY_CENTS);
+	close(fd);
+	free(batch);
+	return strcmp(expected, last) != 0;
+}
+
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		ERROR(USAGE);
+	}
+	long clients = argc > 2 ? atol(argv[2]) : DEFAULT_CLIENTS;
+	long entries = argc > 3 ? atol(argv[3]) : DEFAULT_ENTRIES;
+	long pipeline = argc > 4 ? atol(argv[4]) : DEFAULT_PIPELINE;
+	if (clients <= 0 || entries <= 0 || pipeline <= 0) {
+		ERROR(USAGE);
+	}
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (long i = 0; i < clients; i++) {
+		if (fork() == 0)
+			exit(s_client(argv[1], entries, pipeline));
+	}
+	int status, failures = 0;
+	while (wait(&status) > 0)
+		failures += !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	double secs = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("%ld clients x %ld entries in %.3f s: %.0f entries/s\n",
+			clients, entries, secs, clients * entries / secs);
+	if (failures > 0) {
+		fprintf(stderr, "%s: %d clients saw a wrong total\n", PROGRAM_TITLE, failures);
+		return 1;
+	}
+	return 0;
+}
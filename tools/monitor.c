@@ -0,0 +1,43 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "utils.h"
+#include "io.h"
+#include "publish.h"
+
+
+#define USAGE "usage: monitor.bin [SHM_NAME] [INTERVAL_MS]"
+
+
+// Print one snapshot of a register's published total
+static void s_print(const PublishedTotal *published) {
+	char line[MAX_BUFFER_SIZE];
+	struct timespec now;
+	TotalSnapshot snap = publish_read(published);
+	clock_gettime(CLOCK_REALTIME, &now);
+	double age = ((now.tv_sec * 1000000000UL + now.tv_nsec) - snap.updated_ns) / 1e9;
+	sprint_currency(line, MAX_BUFFER_SIZE, "%s", snap.total);
+	printf("%s over %lu entries, updated %.3f s ago\n", line, snap.count, age);
+	fflush(stdout);
+}
+
+
+int main(int argc, char **argv) {
+	const char *name = argc > 1 ? argv[1] : PUBLISH_DEFAULT_NAME;
+	long interval_ms = argc > 2 ? atol(argv[2]) : 0;
+	if (argc > 3 || interval_ms < 0) {
+		ERROR(USAGE);
+	}
+	const PublishedTotal *published = publish_attach(name);
+	if (published == NULL) {
+		ERROR("No register is publishing under that name");
+	}
+	// Print once, or poll forever when given an interval
+	do {
+		s_print(published);
+	} while (interval_ms > 0 && usleep(interval_ms * 1000) == 0);
+	publish_detach(published);
+	return 0;
+}
@@ -0,0 +1,223 @@
+#include <fcntl.h>
+#include <libgen.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utils.h"
+#include "io.h"
+#include "histogram.h"
+#include "journal.h"
+#include "pool.h"
+#include "sketch.h"
+#include "topk.h"
+
+
+#define USAGE "usage: settle.bin [-j WORKERS] [-t K] [-H] JOURNAL..."
+
+// Files larger than this are split into chunks of this size, so idle workers can steal them
+#define CHUNK_SIZE (4 << 20)
+#define BATCH_SIZE 4096
+
+
+typedef struct Chunk Chunk;
+
+// A register's journal, mapped into memory while chunks of it are totalled
+typedef struct {
+	const char *path;
+	const char *data;
+	size_t size;
+	bool failed;
+	atomic_ulong total;
+	atomic_ulong lines;
+	pthread_mutex_t lock;      // Guards quantiles and histogram, into which each chunk's are merged
+	Sketch quantiles;
+	Histogram histogram;
+	Chunk *chunks;
+	size_t chunk_count;
+} Register;
+
+// The lines of a journal beginning within [start, end), and the largest entries among
+// 	them, numbered from the chunk's first line until chunks are merged in order
+struct Chunk {
+	Register *reg;
+	size_t start;
+	size_t end;
+	uint64 lines;
+	TopK top;
+};
+
+
+static size_t top_k = 0;
+static bool show_histogram = false;
+
+
+// Total every line that begins within a chunk
+static void s_total_chunk(Pool *pool, void *arg) {
+	(void) pool;
+	Chunk *chunk = arg;
+	const char *data = chunk->reg->data, *nl;
+	size_t size = chunk->reg->size, begin = chunk->start, stop = chunk->end;
+	Currency amounts[BATCH_SIZE], total = 0;
+	size_t lines = 0, consumed;
+	Histogram histogram;
+	Sketch *sketch = malloc(sizeof(Sketch));
+	if (sketch == NULL) {
+		ERROR("Out of memory");
+	}
+	sketch_init(sketch);
+	histogram_init(&histogram);
+	topk_init(&chunk->top, top_k);
+	// A line straddling the start belongs to the previous chunk
+	if (begin > 0 && data[begin-1] != '\n') {
+		nl = memchr(data + begin, '\n', size - begin);
+		begin = nl != NULL ? (size_t) (nl + 1 - data) : size;
+	}
+	// The line straddling the end belongs to this chunk
+	if (stop < size) {
+		nl = memchr(data + stop - 1, '\n', size - stop + 1);
+		stop = nl != NULL ? (size_t) (nl + 1 - data) : size;
+	}
+	while (begin < stop) {
+		size_t n = journal_parse(data + begin, stop - begin, true, amounts, BATCH_SIZE, &consumed);
+		for (size_t i = 0; i < n; i++) {
+			total += amounts[i];
+			sketch_add(sketch, amounts[i]);
+		}
+		histogram_add_batch(&histogram, amounts, n);
+		topk_offer_batch(&chunk->top, amounts, n, lines + 1);
+		lines += n;
+		begin += consumed;
+	}
+	atomic_fetch_add_explicit(&chunk->reg->total, total, memory_order_relaxed);
+	atomic_fetch_add_explicit(&chunk->reg->lines, lines, memory_order_relaxed);
+	pthread_mutex_lock(&chunk->reg->lock);
+	sketch_merge(&chunk->reg->quantiles, sketch);
+	histogram_merge(&chunk->reg->histogram, &histogram);
+	pthread_mutex_unlock(&chunk->reg->lock);
+	chunk->lines = lines;
+	free(sketch);
+}
+
+// Map a register's journal, then split it into chunks for the pool
+static void s_total_register(Pool *pool, void *arg) {
+	Register *reg = arg;
+	struct stat st;
+	int fd = open(reg->path, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		reg->failed = true;
+		if (fd >= 0)
+			close(fd);
+		return;
+	}
+	reg->size = st.st_size;
+	if (reg->size > 0) {
+		reg->data = mmap(NULL, reg->size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (reg->data == MAP_FAILED) {
+			reg->data = NULL;
+			reg->failed = true;
+		}
+	}
+	close(fd);
+	if (reg->data == NULL)
+		return;
+	reg->chunk_count = (reg->size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	if ((reg->chunks = calloc(reg->chunk_count, sizeof(Chunk))) == NULL) {
+		ERROR("Out of memory");
+	}
+	for (size_t start = 0; start < reg->size; start += CHUNK_SIZE) {
+		Chunk *chunk = &reg->chunks[start / CHUNK_SIZE];
+		chunk->reg = reg;
+		chunk->start = start;
+		chunk->end = start + CHUNK_SIZE < reg->size ? start + CHUNK_SIZE : reg->size;
+		pool_submit(pool, s_total_chunk, chunk);
+	}
+}
+
+// Merge the largest entries of each chunk in order, numbering their lines from the
+// 	start of the journal, and print them
+static void s_print_largest(const Register *reg) {
+	TopK top;
+	TopEntry largest[TOPK_MAX];
+	uint64 preceding = 0;
+	topk_init(&top, top_k);
+	for (size_t i = 0; i < reg->chunk_count; i++) {
+		topk_merge(&top, &reg->chunks[i].top, preceding);
+		preceding += reg->chunks[i].lines;
+	}
+	size_t n = topk_sorted(&top, largest);
+	for (size_t i = 0; i < n; i++) {
+		printf("  line %lu ", largest[i].line);
+		print_currency("%s\n", largest[i].amount);
+	}
+}
+
+
+int main(int argc, char **argv) {
+	long workers = sysconf(_SC_NPROCESSORS_ONLN);
+	int opt;
+	while ((opt = getopt(argc, argv, "j:t:H")) != -1) {
+		if (opt == 'j' && (workers = atol(optarg)) > 0)
+			continue;
+		if (opt == 'H')
+			show_histogram = true;
+		else if (opt == 't' && atol(optarg) > 0 && atol(optarg) <= TOPK_MAX)
+			top_k = atol(optarg);
+		else {
+			ERROR(USAGE);
+		}
+	}
+	if (optind == argc) {
+		ERROR(USAGE);
+	}
+	size_t count = argc - optind;
+	Register *regs = calloc(count, sizeof(Register));
+	Pool *pool = pool_create(workers);
+	if (regs == NULL || pool == NULL) {
+		ERROR("Unable to start workers");
+	}
+	for (size_t i = 0; i < count; i++) {
+		regs[i].path = argv[optind + i];
+		pthread_mutex_init(&regs[i].lock, NULL);
+		sketch_init(&regs[i].quantiles);
+		histogram_init(&regs[i].histogram);
+		pool_submit(pool, s_total_register, &regs[i]);
+	}
+	pool_wait(pool);
+	pool_destroy(pool);
+
+	Currency grand = 0;
+	int status = 0;
+	for (size_t i = 0; i < count; i++) {
+		char *path = strdup(regs[i].path);
+		if (regs[i].failed) {
+			fprintf(stderr, "%s: Unable to read %s\n", PROGRAM_TITLE, regs[i].path);
+			status = 1;
+		}
+		else {
+			Currency total = atomic_load(&regs[i].total);
+			printf("%s: %lu entries ", basename(path), atomic_load(&regs[i].lines));
+			print_currency("=> %s\n", total);
+			print_currency("  p50 %s", sketch_quantile(&regs[i].quantiles, 0.50));
+			print_currency(", p95 %s", sketch_quantile(&regs[i].quantiles, 0.95));
+			print_currency(", p99 %s\n", sketch_quantile(&regs[i].quantiles, 0.99));
+			s_print_largest(&regs[i]);
+			if (show_histogram)
+				histogram_dump(&regs[i].histogram, stdout, "  ");
+			grand += total;
+		}
+		free(path);
+		pthread_mutex_destroy(&regs[i].lock);
+		free(regs[i].chunks);
+		if (regs[i].data != NULL)
+			munmap((void*) regs[i].data, regs[i].size);
+	}
+	print_currency("Grand total => %s\n", grand);
+	free(regs);
+	return status;
+}